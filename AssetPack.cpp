@@ -0,0 +1,351 @@
+#include "AssetPack.h"
+
+#include <cstring>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+
+namespace Lumen {
+	namespace {
+		const char PackMagic[4] = { 'L', 'P', 'A', 'K' };
+
+		enum EntryType : uint32_t {
+			MeshEntry = 1,
+			TextureEntry = 2,
+		};
+
+		struct PackHeader {
+			char magic[4];
+			uint32_t version;
+			uint32_t entryCount;
+			uint32_t reserved;
+			uint64_t tocOffset;
+			uint64_t reserved2;
+		};
+
+		struct TocEntry {
+			char name[56];
+			uint32_t type;
+			uint32_t reserved;
+			uint64_t offset;
+			uint64_t size;
+		};
+
+		struct MeshHeader {
+			uint32_t vertexSize;
+			uint32_t indexCount;
+			uint32_t indexSize;
+			uint32_t indexType;
+			uint32_t stride;
+			uint32_t attributeCount;
+			uint64_t vertexOffset;	// relative to the start of the entry
+			uint64_t indexOffset;
+		};
+
+		struct MeshAttribute {
+			uint32_t type;
+			uint32_t count;
+			uint32_t normalized;
+			uint32_t reserved;
+		};
+
+		struct TextureHeader {
+			uint32_t format;
+			uint32_t levelCount;
+			uint32_t reserved[2];
+		};
+
+		struct TextureLevelRecord {
+			uint32_t width;
+			uint32_t height;
+			uint64_t offset;		// relative to the start of the entry
+			uint64_t size;
+		};
+
+		size_t Align16(size_t value)
+		{
+			return (value + 15) & ~(size_t)15;
+		}
+
+		template<typename T>
+		void Append(std::vector<unsigned char>& out, const T& value)
+		{
+			const unsigned char *bytes = (const unsigned char *)&value;
+			out.insert(out.end(), bytes, bytes + sizeof(T));
+		}
+
+		// Appends 16 byte aligned data and returns its offset
+		size_t AppendAligned(std::vector<unsigned char>& out, const void *data, size_t size)
+		{
+			out.resize(Align16(out.size()));
+			const size_t offset = out.size();
+			const unsigned char *bytes = (const unsigned char *)data;
+			out.insert(out.end(), bytes, bytes + size);
+			return offset;
+		}
+	}
+
+	bool AssetPack::Open(const std::string& path)
+	{
+		Close();
+		if (!m_file.Open(path)) {
+			return false;
+		}
+
+		const unsigned char *data = m_file.GetData();
+		const size_t size = m_file.GetSize();
+		PackHeader header;
+		if (size < sizeof(header)) {
+			std::cerr << path << ": not an asset pack" << std::endl;
+			Close();
+			return false;
+		}
+		std::memcpy(&header, data, sizeof(header));
+		if (std::memcmp(header.magic, PackMagic, 4) != 0) {
+			std::cerr << path << ": not an asset pack" << std::endl;
+			Close();
+			return false;
+		}
+		if (header.version != Version) {
+			std::cerr << path << ": asset pack version " << header.version << ", expected " << Version << ", recook it" << std::endl;
+			Close();
+			return false;
+		}
+		if (header.tocOffset > size || (uint64_t)header.entryCount * sizeof(TocEntry) > size - header.tocOffset) {
+			std::cerr << path << ": truncated asset pack" << std::endl;
+			Close();
+			return false;
+		}
+
+		const TocEntry *toc = (const TocEntry *)(data + header.tocOffset);
+		for (uint i = 0; i < header.entryCount; i++) {
+			// a name using all 56 bytes has no terminator
+			const std::string name(toc[i].name, strnlen(toc[i].name, sizeof(toc[i].name)));
+			if (toc[i].offset > size || toc[i].size > size - toc[i].offset) {
+				std::cerr << path << ": entry '" << name << "' is out of bounds" << std::endl;
+				continue;
+			}
+			m_entries[name] = { toc[i].type, (size_t)toc[i].offset, (size_t)toc[i].size };
+		}
+		return true;
+	}
+
+	void AssetPack::Close()
+	{
+		m_entries.clear();
+		m_file.Close();
+	}
+
+	const AssetPack::Entry *AssetPack::Find(const std::string& name, uint type) const
+	{
+		auto it = m_entries.find(name);
+		if (it == m_entries.end() || it->second.type != type) {
+			std::cerr << "AssetPack: no " << (type == MeshEntry ? "mesh" : "texture") << " named '" << name << "'" << std::endl;
+			return nullptr;
+		}
+		return &it->second;
+	}
+
+	bool AssetPack::GetMesh(const std::string& name, Mesh& mesh) const
+	{
+		const Entry *entry = Find(name, MeshEntry);
+		if (!entry || entry->size < sizeof(MeshHeader)) {
+			return false;
+		}
+
+		const unsigned char *base = m_file.GetData() + entry->offset;
+		MeshHeader header;
+		std::memcpy(&header, base, sizeof(header));
+		if (sizeof(MeshHeader) + (uint64_t)header.attributeCount * sizeof(MeshAttribute) > entry->size ||
+			header.vertexOffset > entry->size || header.vertexSize > entry->size - header.vertexOffset ||
+			header.indexOffset > entry->size || header.indexSize > entry->size - header.indexOffset) {
+			std::cerr << "AssetPack: mesh '" << name << "' is corrupt" << std::endl;
+			return false;
+		}
+
+		// the buffers are built from these sizes, they have to agree with the layout and index type
+		const uint indexTypeSize = header.indexType == GL_UNSIGNED_SHORT ? 2 : header.indexType == GL_UNSIGNED_BYTE ? 1 : header.indexType == GL_UNSIGNED_INT ? 4 : 0;
+		if (!indexTypeSize || header.indexSize != (uint64_t)header.indexCount * indexTypeSize) {
+			std::cerr << "AssetPack: mesh '" << name << "' has inconsistent index data" << std::endl;
+			return false;
+		}
+
+		mesh.layout = VertexBufferLayout();
+		const MeshAttribute *attributes = (const MeshAttribute *)(base + sizeof(MeshHeader));
+		for (uint i = 0; i < header.attributeCount; i++) {
+			if (!VertexBufferLayoutElement::GetSizeOfType(attributes[i].type) || attributes[i].count == 0 || attributes[i].count > 4) {
+				std::cerr << "AssetPack: mesh '" << name << "' has an invalid attribute" << std::endl;
+				return false;
+			}
+			mesh.layout.PushElement(attributes[i].type, attributes[i].count, (unsigned char)attributes[i].normalized);
+		}
+		if (header.stride == 0 || header.stride != mesh.layout.GetStride() || header.vertexSize % header.stride != 0) {
+			std::cerr << "AssetPack: mesh '" << name << "' stride " << header.stride << " does not match its layout" << std::endl;
+			return false;
+		}
+
+		mesh.vertices = base + header.vertexOffset;
+		mesh.vertexSize = header.vertexSize;
+		mesh.vertexCount = header.vertexSize / header.stride;
+		mesh.indices = base + header.indexOffset;
+		mesh.indexCount = header.indexCount;
+		mesh.indexSize = header.indexSize;
+		mesh.indexType = header.indexType;
+		return true;
+	}
+
+	bool AssetPack::GetTexture(const std::string& name, TextureData& texture) const
+	{
+		const Entry *entry = Find(name, TextureEntry);
+		if (!entry || entry->size < sizeof(TextureHeader)) {
+			return false;
+		}
+
+		const unsigned char *base = m_file.GetData() + entry->offset;
+		TextureHeader header;
+		std::memcpy(&header, base, sizeof(header));
+		if (sizeof(TextureHeader) + header.levelCount * sizeof(TextureLevelRecord) > entry->size) {
+			std::cerr << "AssetPack: texture '" << name << "' is corrupt" << std::endl;
+			return false;
+		}
+
+		if (header.format != GL_RGBA8 && !TextureData::GetBlockSize(header.format)) {
+			std::cerr << "AssetPack: texture '" << name << "' has unknown format " << header.format << std::endl;
+			return false;
+		}
+
+		texture = TextureData();
+		texture.format = header.format;
+		const TextureLevelRecord *levels = (const TextureLevelRecord *)(base + sizeof(TextureHeader));
+		for (uint i = 0; i < header.levelCount; i++) {
+			const TextureLevelRecord& level = levels[i];
+			if (level.width == 0 || level.height == 0 || level.width > TextureData::MaxDimension || level.height > TextureData::MaxDimension ||
+				level.offset > entry->size || level.size > entry->size - level.offset) {
+				std::cerr << "AssetPack: texture '" << name << "' is corrupt" << std::endl;
+				return false;
+			}
+
+			// GL reads exactly pitch * rows bytes from the mapping, whatever the record claims
+			texture.levels.push_back({ level.width, level.height, (size_t)level.offset, 0 });
+			const size_t size = texture.GetRowPitch(i) * texture.GetRowCount(i);
+			if (level.size != size) {
+				std::cerr << "AssetPack: texture '" << name << "' level " << i << " holds " << level.size << " bytes, "
+					<< level.width << "x" << level.height << " needs " << size << std::endl;
+				return false;
+			}
+			texture.levels.back().size = size;
+		}
+		texture.SetExternal(base);
+		return true;
+	}
+
+	std::shared_ptr<VertexArray> AssetPack::CreateVertexArray(const std::string& name, Mesh *out) const
+	{
+		Mesh mesh;
+		if (!GetMesh(name, mesh)) {
+			return nullptr;
+		}
+
+		auto vertexArray = std::make_shared<VertexArray>();
+		auto vertexBuffer = std::make_shared<VertexBuffer>(mesh.vertices, mesh.vertexSize);
+		vertexArray->AddBuffer(vertexBuffer, mesh.layout);
+		vertexArray->AddVertexBuffer(vertexBuffer);
+		vertexArray->AddIndexBuffer(std::make_shared<IndexBuffer>(mesh.indices, mesh.indexSize, GL_STATIC_DRAW, mesh.indexType));
+
+		if (out) {
+			*out = mesh;
+		}
+		return vertexArray;
+	}
+
+	std::shared_ptr<Texture> AssetPack::CreateTexture(const std::string& name) const
+	{
+		TextureData data;
+		if (!GetTexture(name, data)) {
+			return nullptr;
+		}
+		return std::make_shared<Texture>(data);
+	}
+
+	std::vector<std::string> AssetPack::GetNames() const
+	{
+		std::vector<std::string> names;
+		for (const auto& entry : m_entries) {
+			names.push_back(entry.first);
+		}
+		return names;
+	}
+
+	void AssetPackWriter::AddMesh(const std::string& name, const VertexBufferLayout& layout, const void *vertices, uint vertexSize,
+		const void *indices, uint indexCount, GLenum indexType)
+	{
+		const uint indexSize = indexCount * (indexType == GL_UNSIGNED_SHORT ? 2 : indexType == GL_UNSIGNED_BYTE ? 1 : 4);
+		const auto& elements = layout.GetElements();
+
+		Blob blob;
+		blob.name = name;
+		blob.type = MeshEntry;
+		// header is patched once the payload offsets are known
+		MeshHeader header = { vertexSize, indexCount, indexSize, indexType, layout.GetStride(), (uint32_t)elements.size(), 0, 0 };
+		Append(blob.data, header);
+		for (const auto& element : elements) {
+			Append(blob.data, MeshAttribute { element.type, element.count, element.normalized, 0 });
+		}
+		header.vertexOffset = AppendAligned(blob.data, vertices, vertexSize);
+		header.indexOffset = AppendAligned(blob.data, indices, indexSize);
+		std::memcpy(blob.data.data(), &header, sizeof(header));
+
+		m_blobs.push_back(std::move(blob));
+	}
+
+	void AssetPackWriter::AddTexture(const std::string& name, const TextureData& texture)
+	{
+		Blob blob;
+		blob.name = name;
+		blob.type = TextureEntry;
+		Append(blob.data, TextureHeader { texture.format, (uint32_t)texture.levels.size(), { 0, 0 } });
+
+		const size_t recordsOffset = blob.data.size();
+		blob.data.resize(recordsOffset + texture.levels.size() * sizeof(TextureLevelRecord));
+		for (size_t i = 0; i < texture.levels.size(); i++) {
+			const TextureLevel& level = texture.levels[i];
+			TextureLevelRecord record = { level.width, level.height, 0, level.size };
+			record.offset = AppendAligned(blob.data, texture.GetBytes() + level.offset, level.size);
+			std::memcpy(blob.data.data() + recordsOffset + i * sizeof(record), &record, sizeof(record));
+		}
+
+		m_blobs.push_back(std::move(blob));
+	}
+
+	bool AssetPackWriter::Write(const std::string& path) const
+	{
+		std::vector<unsigned char> out;
+		PackHeader header = { { PackMagic[0], PackMagic[1], PackMagic[2], PackMagic[3] }, AssetPack::Version, (uint32_t)m_blobs.size(), 0, 0, 0 };
+		Append(out, header);
+
+		std::vector<TocEntry> toc;
+		for (const Blob& blob : m_blobs) {
+			if (blob.name.size() >= sizeof(TocEntry::name)) {
+				std::cerr << "AssetPackWriter: name '" << blob.name << "' is longer than " << sizeof(TocEntry::name) - 1 << " characters" << std::endl;
+				return false;
+			}
+			TocEntry entry = { };
+			std::memcpy(entry.name, blob.name.c_str(), blob.name.size());
+			entry.type = blob.type;
+			entry.size = blob.data.size();
+			entry.offset = AppendAligned(out, blob.data.data(), blob.data.size());
+			toc.push_back(entry);
+		}
+
+		header.tocOffset = AppendAligned(out, toc.data(), toc.size() * sizeof(TocEntry));
+		std::memcpy(out.data(), &header, sizeof(header));
+
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		if (!file.is_open()) {
+			std::cerr << "AssetPackWriter: failed to write " << path << std::endl;
+			return false;
+		}
+		file.write((const char *)out.data(), out.size());
+		return (bool)file;
+	}
+}
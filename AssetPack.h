@@ -0,0 +1,82 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <glad/glad.h>
+#include "types.h"
+#include "MappedFile.h"
+#include "TextureData.h"
+#include "Textures.h"
+#include "VertexArray.h"
+#include "VertexBufferLayout.h"
+
+namespace Lumen {
+	// Cooked asset container (.lpak). Every blob is stored exactly as GL consumes it:
+	// interleaved vertices matching a VertexBufferLayout, index data, and texture levels in
+	// their final (possibly BCn) format, each 16 byte aligned. AssetPack maps the file and
+	// hands those bytes straight to glBufferData / glTexImage2D, nothing is parsed or copied.
+	// The format is little endian and versioned, packs from another version are refused.
+	class AssetPack {
+	public:
+		static const uint Version = 1;
+
+		struct Mesh {
+			const void *vertices = nullptr;
+			uint vertexCount = 0;
+			uint vertexSize = 0;		// bytes
+			const void *indices = nullptr;
+			uint indexCount = 0;
+			uint indexSize = 0;			// bytes
+			GLenum indexType = GL_UNSIGNED_INT;
+			VertexBufferLayout layout;
+		};
+
+		AssetPack() = default;
+		AssetPack(const std::string& path) { Open(path); }
+
+		bool Open(const std::string& path);
+		void Close();
+		bool IsOpen() const { return m_file.IsOpen(); }
+
+		// Views into the mapping, valid while the pack stays open
+		bool GetMesh(const std::string& name, Mesh& mesh) const;
+		bool GetTexture(const std::string& name, TextureData& texture) const;
+
+		// Vertex array with the mesh's vertex and index buffers attached, ready for Renderer::DrawIndexed
+		std::shared_ptr<VertexArray> CreateVertexArray(const std::string& name, Mesh *mesh = nullptr) const;
+		std::shared_ptr<Texture> CreateTexture(const std::string& name) const;
+
+		std::vector<std::string> GetNames() const;
+	private:
+		struct Entry {
+			uint type;
+			size_t offset;
+			size_t size;
+		};
+
+		MappedFile m_file;
+		std::unordered_map<std::string, Entry> m_entries;
+	private:
+		const Entry *Find(const std::string& name, uint type) const;
+	};
+
+	// Builds .lpak files, used by the cooker tool (tools/lumen_cook.cpp)
+	class AssetPackWriter {
+	public:
+		void AddMesh(const std::string& name, const VertexBufferLayout& layout, const void *vertices, uint vertexSize,
+			const void *indices, uint indexCount, GLenum indexType = GL_UNSIGNED_INT);
+		void AddTexture(const std::string& name, const TextureData& texture);
+
+		bool Write(const std::string& path) const;
+	private:
+		struct Blob {
+			std::string name;
+			uint type;
+			std::vector<unsigned char> data;
+		};
+
+		std::vector<Blob> m_blobs;
+	};
+}
@@ -0,0 +1,534 @@
+#include "BVH.h"
+
+#include <cmath>
+#include <limits>
+
+namespace Lumen {
+	static const uint SAHBins = 12;
+
+	static float GetAxis(const cx::Vec3& v, uint axis)
+	{
+		return axis == 0 ? v.x() : axis == 1 ? v.y() : v.z();
+	}
+
+	static cx::Vec3 GetCenter(const AABB& bounds)
+	{
+		return cx::Vec3((bounds.min.x() + bounds.max.x()) * 0.5f, (bounds.min.y() + bounds.max.y()) * 0.5f,
+			(bounds.min.z() + bounds.max.z()) * 0.5f);
+	}
+
+	BVH::BVH(float margin)
+		: m_margin(margin)
+	{
+	}
+
+	void BVH::Clear()
+	{
+		m_nodes.clear();
+		m_proxies.clear();
+		m_freeNodes.clear();
+		m_freeProxies.clear();
+		m_root = Null;
+		m_proxyCount = 0;
+	}
+
+	uint BVH::AllocateNode()
+	{
+		if (!m_freeNodes.empty()) {
+			const uint node = m_freeNodes.back();
+			m_freeNodes.pop_back();
+			m_nodes[node] = Node();
+			return node;
+		}
+		m_nodes.emplace_back();
+		return (uint)m_nodes.size() - 1;
+	}
+
+	void BVH::FreeNode(uint node)
+	{
+		m_nodes[node] = Node();
+		m_freeNodes.push_back(node);
+	}
+
+	uint BVH::Insert(const AABB& bounds, uint data)
+	{
+		uint proxy;
+		if (!m_freeProxies.empty()) {
+			proxy = m_freeProxies.back();
+			m_freeProxies.pop_back();
+		}
+		else {
+			proxy = (uint)m_proxies.size();
+			m_proxies.push_back(Null);
+		}
+
+		const uint leaf = AllocateNode();
+		const cx::Vec3 margin(m_margin);
+		m_nodes[leaf].bounds = AABB(bounds.min - margin, bounds.max + margin);
+		m_nodes[leaf].proxy = proxy;
+		m_nodes[leaf].data = data;
+		m_proxies[proxy] = leaf;
+		m_proxyCount++;
+
+		InsertLeaf(leaf);
+		return proxy;
+	}
+
+	void BVH::Remove(uint proxy)
+	{
+		const uint leaf = m_proxies[proxy];
+		RemoveLeaf(leaf);
+		FreeNode(leaf);
+		m_proxies[proxy] = Null;
+		m_freeProxies.push_back(proxy);
+		m_proxyCount--;
+	}
+
+	bool BVH::Update(uint proxy, const AABB& bounds)
+	{
+		const uint leaf = m_proxies[proxy];
+		if (m_nodes[leaf].bounds.Contains(bounds)) {
+			return false;
+		}
+
+		RemoveLeaf(leaf);
+		const cx::Vec3 margin(m_margin);
+		m_nodes[leaf].bounds = AABB(bounds.min - margin, bounds.max + margin);
+		InsertLeaf(leaf);
+		return true;
+	}
+
+	void BVH::InsertLeaf(uint leaf)
+	{
+		if (m_root == Null) {
+			m_root = leaf;
+			m_nodes[leaf].parent = Null;
+			return;
+		}
+
+		// walk down while descending is cheaper than pairing the leaf with the current node.
+		// Every node above the new parent grows, that inherited cost is charged to both children
+		const AABB bounds = m_nodes[leaf].bounds;
+		uint index = m_root;
+		while (!m_nodes[index].IsLeaf()) {
+			const Node& node = m_nodes[index];
+			const float area = node.bounds.GetSurfaceArea();
+			const float combinedArea = AABB::Union(node.bounds, bounds).GetSurfaceArea();
+
+			const float cost = 2.0f * combinedArea;
+			const float inheritance = 2.0f * (combinedArea - area);
+
+			float childCost[2];
+			const uint children[2] = { node.left, node.right };
+			for (uint i = 0; i < 2; i++) {
+				const Node& child = m_nodes[children[i]];
+				const float merged = AABB::Union(child.bounds, bounds).GetSurfaceArea();
+				childCost[i] = (child.IsLeaf() ? merged : merged - child.bounds.GetSurfaceArea()) + inheritance;
+			}
+
+			if (cost < childCost[0] && cost < childCost[1]) {
+				break;
+			}
+			index = childCost[0] < childCost[1] ? node.left : node.right;
+		}
+
+		const uint sibling = index;
+		const uint oldParent = m_nodes[sibling].parent;
+		const uint parent = AllocateNode();
+		m_nodes[parent].parent = oldParent;
+		m_nodes[parent].left = sibling;
+		m_nodes[parent].right = leaf;
+		m_nodes[parent].bounds = AABB::Union(m_nodes[sibling].bounds, bounds);
+		m_nodes[sibling].parent = parent;
+		m_nodes[leaf].parent = parent;
+
+		if (oldParent == Null) {
+			m_root = parent;
+		}
+		else if (m_nodes[oldParent].left == sibling) {
+			m_nodes[oldParent].left = parent;
+		}
+		else {
+			m_nodes[oldParent].right = parent;
+		}
+
+		Refit(oldParent);
+	}
+
+	void BVH::RemoveLeaf(uint leaf)
+	{
+		if (leaf == m_root) {
+			m_root = Null;
+			return;
+		}
+
+		const uint parent = m_nodes[leaf].parent;
+		const uint grandParent = m_nodes[parent].parent;
+		const uint sibling = m_nodes[parent].left == leaf ? m_nodes[parent].right : m_nodes[parent].left;
+
+		m_nodes[sibling].parent = grandParent;
+		if (grandParent == Null) {
+			m_root = sibling;
+		}
+		else {
+			if (m_nodes[grandParent].left == parent) {
+				m_nodes[grandParent].left = sibling;
+			}
+			else {
+				m_nodes[grandParent].right = sibling;
+			}
+		}
+		FreeNode(parent);
+		m_nodes[leaf].parent = Null;
+
+		Refit(grandParent);
+	}
+
+	void BVH::Refit(uint node)
+	{
+		while (node != Null) {
+			Node& current = m_nodes[node];
+			current.bounds = AABB::Union(m_nodes[current.left].bounds, m_nodes[current.right].bounds);
+			Rotate(node);
+			node = m_nodes[node].parent;
+		}
+	}
+
+	void BVH::Rotate(uint node)
+	{
+		// candidate swaps of a child with one of its sibling's children, judged by how much
+		// the sibling's box shrinks. The node's own box does not change
+		const uint children[2] = { m_nodes[node].left, m_nodes[node].right };
+		float bestGain = 0.0f;
+		uint bestChild = Null, bestGrandChild = Null, bestInner = Null;
+
+		for (uint i = 0; i < 2; i++) {
+			const uint child = children[i];
+			const uint inner = children[1 - i];
+			if (m_nodes[inner].IsLeaf()) {
+				continue;
+			}
+
+			const float area = m_nodes[inner].bounds.GetSurfaceArea();
+			const uint grandChildren[2] = { m_nodes[inner].left, m_nodes[inner].right };
+			for (uint j = 0; j < 2; j++) {
+				// child goes down in place of grandChildren[j], which comes up
+				const float rotated = AABB::Union(m_nodes[child].bounds, m_nodes[grandChildren[1 - j]].bounds).GetSurfaceArea();
+				const float gain = area - rotated;
+				if (gain > bestGain) {
+					bestGain = gain;
+					bestChild = child;
+					bestGrandChild = grandChildren[j];
+					bestInner = inner;
+				}
+			}
+		}
+
+		if (bestChild == Null) {
+			return;
+		}
+
+		Node& parent = m_nodes[node];
+		if (parent.left == bestChild) {
+			parent.left = bestGrandChild;
+		}
+		else {
+			parent.right = bestGrandChild;
+		}
+
+		Node& inner = m_nodes[bestInner];
+		if (inner.left == bestGrandChild) {
+			inner.left = bestChild;
+		}
+		else {
+			inner.right = bestChild;
+		}
+
+		m_nodes[bestGrandChild].parent = node;
+		m_nodes[bestChild].parent = bestInner;
+		inner.bounds = AABB::Union(m_nodes[inner.left].bounds, m_nodes[inner.right].bounds);
+	}
+
+	void BVH::Build()
+	{
+		std::vector<uint> leaves;
+		leaves.reserve(m_proxyCount);
+		for (uint leaf : m_proxies) {
+			if (leaf != Null) {
+				leaves.push_back(leaf);
+			}
+		}
+
+		std::vector<Node> built;
+		built.reserve(leaves.size() * 2);
+		m_root = leaves.empty() ? Null : BuildRange(leaves, 0, leaves.size(), built, Null);
+
+		m_nodes.swap(built);
+		m_freeNodes.clear();
+		for (uint i = 0; i < m_nodes.size(); i++) {
+			if (m_nodes[i].IsLeaf()) {
+				m_proxies[m_nodes[i].proxy] = i;
+			}
+		}
+	}
+
+	uint BVH::BuildRange(std::vector<uint>& leaves, size_t begin, size_t end, std::vector<Node>& built, uint parent) const
+	{
+		const uint index = (uint)built.size();
+		built.emplace_back();
+		built[index].parent = parent;
+
+		if (end - begin == 1) {
+			built[index] = m_nodes[leaves[begin]];
+			built[index].parent = parent;
+			return index;
+		}
+
+		// bin the centroids along every axis and take the split with the lowest SAH cost
+		AABB centroids(GetCenter(m_nodes[leaves[begin]].bounds), GetCenter(m_nodes[leaves[begin]].bounds));
+		for (size_t i = begin + 1; i < end; i++) {
+			const cx::Vec3 center = GetCenter(m_nodes[leaves[i]].bounds);
+			centroids = AABB::Union(centroids, AABB(center, center));
+		}
+
+		float bestCost = std::numeric_limits<float>::max();
+		uint bestAxis = 0, bestSplit = 0;
+		for (uint axis = 0; axis < 3; axis++) {
+			const float low = GetAxis(centroids.min, axis);
+			const float extent = GetAxis(centroids.max, axis) - low;
+			if (extent <= 0.0f) {
+				continue;
+			}
+
+			AABB binBounds[SAHBins];
+			uint binCounts[SAHBins] = {};
+			for (size_t i = begin; i < end; i++) {
+				const AABB& bounds = m_nodes[leaves[i]].bounds;
+				const uint bin = std::min(SAHBins - 1, (uint)((GetAxis(GetCenter(bounds), axis) - low) / extent * SAHBins));
+				binBounds[bin] = binCounts[bin] ? AABB::Union(binBounds[bin], bounds) : bounds;
+				binCounts[bin]++;
+			}
+
+			// right to left sweep first, then score each split on the way back
+			float rightArea[SAHBins];
+			uint rightCount[SAHBins];
+			AABB accumulated;
+			uint count = 0;
+			for (uint bin = SAHBins - 1; bin > 0; bin--) {
+				if (binCounts[bin]) {
+					accumulated = count ? AABB::Union(accumulated, binBounds[bin]) : binBounds[bin];
+					count += binCounts[bin];
+				}
+				rightArea[bin] = count ? accumulated.GetSurfaceArea() : 0.0f;
+				rightCount[bin] = count;
+			}
+
+			count = 0;
+			for (uint split = 1; split < SAHBins; split++) {
+				const uint bin = split - 1;
+				if (binCounts[bin]) {
+					accumulated = count ? AABB::Union(accumulated, binBounds[bin]) : binBounds[bin];
+					count += binCounts[bin];
+				}
+				if (!count || !rightCount[split]) {
+					continue;
+				}
+				const float cost = accumulated.GetSurfaceArea() * count + rightArea[split] * rightCount[split];
+				if (cost < bestCost) {
+					bestCost = cost;
+					bestAxis = axis;
+					bestSplit = split;
+				}
+			}
+		}
+
+		size_t middle;
+		if (bestSplit) {
+			const float low = GetAxis(centroids.min, bestAxis);
+			const float extent = GetAxis(centroids.max, bestAxis) - low;
+			middle = std::partition(leaves.begin() + begin, leaves.begin() + end, [&](uint leaf) {
+				const float center = GetAxis(GetCenter(m_nodes[leaf].bounds), bestAxis);
+				return std::min(SAHBins - 1, (uint)((center - low) / extent * SAHBins)) < bestSplit;
+			}) - leaves.begin();
+		}
+		else {
+			// every centroid in the same spot, any split is as good as another
+			middle = (begin + end) / 2;
+		}
+
+		const uint left = BuildRange(leaves, begin, middle, built, index);
+		const uint right = BuildRange(leaves, middle, end, built, index);
+		built[index].left = left;
+		built[index].right = right;
+		built[index].bounds = AABB::Union(built[left].bounds, built[right].bounds);
+		return index;
+	}
+
+	void BVH::QueryFrustum(const Frustum& frustum, std::vector<uint>& results) const
+	{
+		if (m_root == Null) {
+			return;
+		}
+
+		std::vector<uint> stack;
+		stack.reserve(64);
+		stack.push_back(m_root);
+		while (!stack.empty()) {
+			const Node& node = m_nodes[stack.back()];
+			stack.pop_back();
+			if (!frustum.TestAABB(node.bounds.min, node.bounds.max)) {
+				continue;
+			}
+			if (node.IsLeaf()) {
+				results.push_back(node.data);
+			}
+			else {
+				stack.push_back(node.right);
+				stack.push_back(node.left);
+			}
+		}
+	}
+
+	void BVH::QueryAABB(const AABB& bounds, std::vector<uint>& results) const
+	{
+		if (m_root == Null) {
+			return;
+		}
+
+		std::vector<uint> stack;
+		stack.reserve(64);
+		stack.push_back(m_root);
+		while (!stack.empty()) {
+			const Node& node = m_nodes[stack.back()];
+			stack.pop_back();
+			if (!node.bounds.Overlaps(bounds)) {
+				continue;
+			}
+			if (node.IsLeaf()) {
+				results.push_back(node.data);
+			}
+			else {
+				stack.push_back(node.right);
+				stack.push_back(node.left);
+			}
+		}
+	}
+
+	// Slab test, returns the entry distance or a negative value on a miss
+	static float IntersectRay(const AABB& bounds, const float origin[3], const float inverse[3], float maxDistance)
+	{
+		float entry = 0.0f, exit = maxDistance;
+		for (uint axis = 0; axis < 3; axis++) {
+			float t0 = (GetAxis(bounds.min, axis) - origin[axis]) * inverse[axis];
+			float t1 = (GetAxis(bounds.max, axis) - origin[axis]) * inverse[axis];
+			if (t0 > t1) {
+				std::swap(t0, t1);
+			}
+			entry = std::max(entry, t0);
+			exit = std::min(exit, t1);
+			if (entry > exit) {
+				return -1.0f;
+			}
+		}
+		return entry;
+	}
+
+	bool BVH::RayCast(const cx::Vec3& origin, const cx::Vec3& direction, float maxDistance, RayHit& hit) const
+	{
+		if (m_root == Null) {
+			return false;
+		}
+
+		// 1/0 gives infinities, which the slab test handles; NaN from 0 * inf only occurs
+		// for rays lying exactly in a slab plane
+		const float start[3] = { origin.x(), origin.y(), origin.z() };
+		const float inverse[3] = { 1.0f / direction.x(), 1.0f / direction.y(), 1.0f / direction.z() };
+
+		float closest = maxDistance;
+		bool found = false;
+		std::vector<std::pair<uint, float>> stack;
+		stack.reserve(64);
+		const float rootDistance = IntersectRay(m_nodes[m_root].bounds, start, inverse, closest);
+		if (rootDistance >= 0.0f) {
+			stack.emplace_back(m_root, rootDistance);
+		}
+
+		while (!stack.empty()) {
+			const std::pair<uint, float> entry = stack.back();
+			stack.pop_back();
+			if (entry.second > closest) {
+				continue;
+			}
+
+			const Node& node = m_nodes[entry.first];
+			if (node.IsLeaf()) {
+				closest = entry.second;
+				hit.proxy = node.proxy;
+				hit.data = node.data;
+				hit.distance = entry.second;
+				found = true;
+				continue;
+			}
+
+			// visit the nearer child first so the far one is usually pruned
+			const float left = IntersectRay(m_nodes[node.left].bounds, start, inverse, closest);
+			const float right = IntersectRay(m_nodes[node.right].bounds, start, inverse, closest);
+			const bool leftFirst = left >= 0.0f && (right < 0.0f || left <= right);
+			if (leftFirst) {
+				if (right >= 0.0f) {
+					stack.emplace_back(node.right, right);
+				}
+				stack.emplace_back(node.left, left);
+			}
+			else {
+				if (left >= 0.0f) {
+					stack.emplace_back(node.left, left);
+				}
+				if (right >= 0.0f) {
+					stack.emplace_back(node.right, right);
+				}
+			}
+		}
+		return found;
+	}
+
+	bool BVH::RayCast(const Camera& camera, float maxDistance, RayHit& hit) const
+	{
+		return RayCast(camera.GetPosition(), camera.GetForward(), maxDistance, hit);
+	}
+
+	float BVH::GetCost() const
+	{
+		if (m_root == Null || m_nodes[m_root].IsLeaf()) {
+			return 0.0f;
+		}
+
+		const float rootArea = m_nodes[m_root].bounds.GetSurfaceArea();
+		float total = 0.0f;
+		std::vector<uint> stack(1, m_root);
+		while (!stack.empty()) {
+			const Node& node = m_nodes[stack.back()];
+			stack.pop_back();
+			if (!node.IsLeaf()) {
+				total += node.bounds.GetSurfaceArea();
+				stack.push_back(node.left);
+				stack.push_back(node.right);
+			}
+		}
+		return rootArea > 0.0f ? total / rootArea : 0.0f;
+	}
+
+	uint BVH::GetDepth() const
+	{
+		return m_root == Null ? 0 : GetDepth(m_root);
+	}
+
+	uint BVH::GetDepth(uint node) const
+	{
+		const Node& current = m_nodes[node];
+		if (current.IsLeaf()) {
+			return 1;
+		}
+		return 1 + std::max(GetDepth(current.left), GetDepth(current.right));
+	}
+}
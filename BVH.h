@@ -0,0 +1,112 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include "types.h"
+#include "Math.h"
+#include "Frustum.h"
+#include "Camera.h"
+
+namespace Lumen {
+	struct AABB {
+		cx::Vec3 min;
+		cx::Vec3 max;
+
+		AABB() = default;
+		AABB(const cx::Vec3& min, const cx::Vec3& max) : min(min), max(max) {}
+
+		bool Overlaps(const AABB& other) const
+		{
+			return min.x() <= other.max.x() && max.x() >= other.min.x() &&
+				min.y() <= other.max.y() && max.y() >= other.min.y() &&
+				min.z() <= other.max.z() && max.z() >= other.min.z();
+		}
+		bool Contains(const AABB& other) const
+		{
+			return min.x() <= other.min.x() && min.y() <= other.min.y() && min.z() <= other.min.z() &&
+				max.x() >= other.max.x() && max.y() >= other.max.y() && max.z() >= other.max.z();
+		}
+		float GetSurfaceArea() const
+		{
+			const float dx = max.x() - min.x(), dy = max.y() - min.y(), dz = max.z() - min.z();
+			return 2.0f * (dx * dy + dy * dz + dz * dx);
+		}
+		static AABB Union(const AABB& a, const AABB& b)
+		{
+			return AABB(cx::Vec3(std::min(a.min.x(), b.min.x()), std::min(a.min.y(), b.min.y()), std::min(a.min.z(), b.min.z())),
+				cx::Vec3(std::max(a.max.x(), b.max.x()), std::max(a.max.y(), b.max.y()), std::max(a.max.z(), b.max.z())));
+		}
+	};
+
+	struct RayHit {
+		uint proxy = ~0u;
+		uint data = 0;
+		float distance = 0.0f;	// along the ray to where it enters the proxy's box
+	};
+
+	// Dynamic bounding volume hierarchy over user boxes ("proxies"), with all nodes in one
+	// flat array. Build() does a binned SAH rebuild laid out depth first, Insert/Remove/Update
+	// keep the tree usable between rebuilds: new leaves descend by SAH cost, and ancestors are
+	// refit on the way up with tree rotations wherever swapping a child with a grandchild
+	// shrinks the surface area, which keeps incremental trees close to built quality.
+	// A non zero margin stores fattened boxes, so Update() is free while an object stays inside.
+	class BVH {
+	public:
+		static constexpr uint Null = ~0u;
+
+		BVH(float margin = 0.0f);
+
+		uint Insert(const AABB& bounds, uint data = 0);
+		void Remove(uint proxy);
+		// Returns true when the proxy had to be moved in the tree
+		bool Update(uint proxy, const AABB& bounds);
+		// Rebuilds the whole tree with the SAH, best after loading a level or many updates
+		void Build();
+		void Clear();
+
+		uint GetData(uint proxy) const { return m_nodes[m_proxies[proxy]].data; }
+		const AABB& GetBounds(uint proxy) const { return m_nodes[m_proxies[proxy]].bounds; }
+		uint GetProxyCount() const { return m_proxyCount; }
+
+		// Append the data of every proxy whose box passes the test
+		void QueryFrustum(const Frustum& frustum, std::vector<uint>& results) const;
+		void QueryAABB(const AABB& bounds, std::vector<uint>& results) const;
+		// Closest proxy box hit within maxDistance; direction does not need to be normalized,
+		// distances are then in units of its length
+		bool RayCast(const cx::Vec3& origin, const cx::Vec3& direction, float maxDistance, RayHit& hit) const;
+		// Along the camera's forward axis, for picking what is in the middle of the screen
+		bool RayCast(const Camera& camera, float maxDistance, RayHit& hit) const;
+
+		// Sum of internal node surface areas relative to the root, lower is better
+		float GetCost() const;
+		uint GetDepth() const;
+	private:
+		struct Node {
+			AABB bounds;
+			uint parent = Null;
+			uint left = Null;
+			uint right = Null;
+			uint proxy = Null;		// leaves only
+			uint data = 0;
+
+			bool IsLeaf() const { return left == Null; }
+		};
+
+		std::vector<Node> m_nodes;
+		std::vector<uint> m_proxies;		// proxy -> leaf node, Null once removed
+		std::vector<uint> m_freeNodes;
+		std::vector<uint> m_freeProxies;
+		uint m_root = Null;
+		uint m_proxyCount = 0;
+		float m_margin;
+	private:
+		uint AllocateNode();
+		void FreeNode(uint node);
+		void InsertLeaf(uint leaf);
+		void RemoveLeaf(uint leaf);
+		void Refit(uint node);
+		void Rotate(uint node);
+		uint BuildRange(std::vector<uint>& leaves, size_t begin, size_t end, std::vector<Node>& built, uint parent) const;
+		uint GetDepth(uint node) const;
+	};
+}
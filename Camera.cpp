@@ -114,6 +114,11 @@ namespace Lumen {
 		return GetProjectionMatrix() * GetViewMatrix();
 	}
 
+	Frustum Camera::GetFrustum() const
+	{
+		return Frustum(GetViewProjectionMatrix());
+	}
+
 	void Camera::RecalculateViewMatrix() const
 	{
 		m_view = cx::Mat4::fromQuat(m_rotation.conjugate().normalize()) * cx::Mat4::translation(-m_position.x(),
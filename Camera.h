@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Math.h"
+#include "Frustum.h"
 
 namespace Lumen {
 	enum class ProjectionType {
@@ -34,6 +35,8 @@ namespace Lumen {
 		void SetFOV(const float fov);
 		void SetAspect(const float aspect);
 		const cx::Mat4 GetViewProjectionMatrix() const;
+		// Clip planes of the current view projection, for culling with Frustum or CullList
+		Frustum GetFrustum() const;
 	private:
 		float m_fov, m_aspect, m_znear, m_zfar;
 		float m_left, m_right, m_top, m_bottom;
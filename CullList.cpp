@@ -0,0 +1,192 @@
+#include "CullList.h"
+
+#include <cmath>
+#include <algorithm>
+
+namespace Lumen {
+	static const size_t CullChunk = 8192;	// entries per job, multiple of 4
+
+	void CullList::Reserve(size_t count)
+	{
+		count = (count + 3) & ~(size_t)3;
+		for (std::vector<float> *array : { &m_centerX, &m_centerY, &m_centerZ, &m_extentX, &m_extentY, &m_extentZ, &m_radius }) {
+			array->reserve(count);
+		}
+	}
+
+	void CullList::Clear()
+	{
+		for (std::vector<float> *array : { &m_centerX, &m_centerY, &m_centerZ, &m_extentX, &m_extentY, &m_extentZ, &m_radius }) {
+			array->clear();
+		}
+		m_count = 0;
+	}
+
+	uint CullList::Append()
+	{
+		if (m_count == m_centerX.size()) {
+			for (std::vector<float> *array : { &m_centerX, &m_centerY, &m_centerZ, &m_extentX, &m_extentY, &m_extentZ, &m_radius }) {
+				array->resize(m_count + 4, 0.0f);
+			}
+		}
+		return (uint)m_count++;
+	}
+
+	uint CullList::AddAABB(const cx::Vec3& min, const cx::Vec3& max)
+	{
+		const uint id = Append();
+		SetAABB(id, min, max);
+		return id;
+	}
+
+	uint CullList::AddSphere(const cx::Vec3& center, float radius)
+	{
+		const uint id = Append();
+		SetSphere(id, center, radius);
+		return id;
+	}
+
+	void CullList::SetAABB(uint id, const cx::Vec3& min, const cx::Vec3& max)
+	{
+		m_centerX[id] = (min.x() + max.x()) * 0.5f;
+		m_centerY[id] = (min.y() + max.y()) * 0.5f;
+		m_centerZ[id] = (min.z() + max.z()) * 0.5f;
+		m_extentX[id] = (max.x() - min.x()) * 0.5f;
+		m_extentY[id] = (max.y() - min.y()) * 0.5f;
+		m_extentZ[id] = (max.z() - min.z()) * 0.5f;
+		m_radius[id] = 0.0f;
+	}
+
+	void CullList::SetSphere(uint id, const cx::Vec3& center, float radius)
+	{
+		m_centerX[id] = center.x();
+		m_centerY[id] = center.y();
+		m_centerZ[id] = center.z();
+		m_extentX[id] = 0.0f;
+		m_extentY[id] = 0.0f;
+		m_extentZ[id] = 0.0f;
+		m_radius[id] = radius;
+	}
+
+	uint CullList::Cull(const Frustum& frustum, std::vector<uint>& visible, JobSystem *jobs) const
+	{
+		visible.clear();
+		if (!jobs || m_count <= CullChunk) {
+			CullRange(frustum, 0, m_count, visible);
+			return (uint)visible.size();
+		}
+
+		const size_t chunks = (m_count + CullChunk - 1) / CullChunk;
+		m_chunkResults.resize(chunks);
+		jobs->ParallelFor(chunks, 1, [&](size_t begin, size_t end) {
+			for (size_t chunk = begin; chunk < end; chunk++) {
+				m_chunkResults[chunk].clear();
+				CullRange(frustum, chunk * CullChunk, std::min(m_count, (chunk + 1) * CullChunk), m_chunkResults[chunk]);
+			}
+		});
+		for (size_t chunk = 0; chunk < chunks; chunk++) {
+			visible.insert(visible.end(), m_chunkResults[chunk].begin(), m_chunkResults[chunk].end());
+		}
+		return (uint)visible.size();
+	}
+
+	void CullList::CullRange(const Frustum& frustum, size_t begin, size_t end, std::vector<uint>& visible) const
+	{
+		// an entry is outside once, for any plane, dot(n, c) + d < -(|n| . e + r)
+#if defined(CX_SIMD_SSE)
+		const __m128 signMask = _mm_set1_ps(-0.0f);
+		__m128 nx[Frustum::PlaneCount], ny[Frustum::PlaneCount], nz[Frustum::PlaneCount], d[Frustum::PlaneCount];
+		__m128 ax[Frustum::PlaneCount], ay[Frustum::PlaneCount], az[Frustum::PlaneCount];
+		for (uint p = 0; p < Frustum::PlaneCount; p++) {
+			const Plane& plane = frustum.GetPlane(p);
+			nx[p] = _mm_set1_ps(plane.nx);
+			ny[p] = _mm_set1_ps(plane.ny);
+			nz[p] = _mm_set1_ps(plane.nz);
+			d[p] = _mm_set1_ps(plane.d);
+			ax[p] = _mm_andnot_ps(signMask, nx[p]);
+			ay[p] = _mm_andnot_ps(signMask, ny[p]);
+			az[p] = _mm_andnot_ps(signMask, nz[p]);
+		}
+
+		for (size_t i = begin; i < end; i += 4) {
+			const __m128 centerX = _mm_loadu_ps(&m_centerX[i]);
+			const __m128 centerY = _mm_loadu_ps(&m_centerY[i]);
+			const __m128 centerZ = _mm_loadu_ps(&m_centerZ[i]);
+			const __m128 extentX = _mm_loadu_ps(&m_extentX[i]);
+			const __m128 extentY = _mm_loadu_ps(&m_extentY[i]);
+			const __m128 extentZ = _mm_loadu_ps(&m_extentZ[i]);
+			const __m128 radius = _mm_loadu_ps(&m_radius[i]);
+
+			__m128 outside = _mm_setzero_ps();
+			for (uint p = 0; p < Frustum::PlaneCount; p++) {
+				__m128 distance = _mm_add_ps(_mm_mul_ps(nx[p], centerX), d[p]);
+				distance = _mm_add_ps(distance, _mm_mul_ps(ny[p], centerY));
+				distance = _mm_add_ps(distance, _mm_mul_ps(nz[p], centerZ));
+				__m128 reach = _mm_add_ps(_mm_mul_ps(ax[p], extentX), radius);
+				reach = _mm_add_ps(reach, _mm_mul_ps(ay[p], extentY));
+				reach = _mm_add_ps(reach, _mm_mul_ps(az[p], extentZ));
+				outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(distance, reach), _mm_setzero_ps()));
+			}
+
+			const int mask = _mm_movemask_ps(outside);
+			for (uint lane = 0; lane < 4; lane++) {
+				if (!(mask & (1 << lane)) && i + lane < end) {
+					visible.push_back((uint)(i + lane));
+				}
+			}
+		}
+#elif defined(CX_SIMD_NEON)
+		float32x4_t nx[Frustum::PlaneCount], ny[Frustum::PlaneCount], nz[Frustum::PlaneCount], d[Frustum::PlaneCount];
+		for (uint p = 0; p < Frustum::PlaneCount; p++) {
+			const Plane& plane = frustum.GetPlane(p);
+			nx[p] = vdupq_n_f32(plane.nx);
+			ny[p] = vdupq_n_f32(plane.ny);
+			nz[p] = vdupq_n_f32(plane.nz);
+			d[p] = vdupq_n_f32(plane.d);
+		}
+
+		for (size_t i = begin; i < end; i += 4) {
+			const float32x4_t centerX = vld1q_f32(&m_centerX[i]);
+			const float32x4_t centerY = vld1q_f32(&m_centerY[i]);
+			const float32x4_t centerZ = vld1q_f32(&m_centerZ[i]);
+			const float32x4_t extentX = vld1q_f32(&m_extentX[i]);
+			const float32x4_t extentY = vld1q_f32(&m_extentY[i]);
+			const float32x4_t extentZ = vld1q_f32(&m_extentZ[i]);
+			const float32x4_t radius = vld1q_f32(&m_radius[i]);
+
+			uint32x4_t outside = vdupq_n_u32(0);
+			for (uint p = 0; p < Frustum::PlaneCount; p++) {
+				float32x4_t distance = vmlaq_f32(d[p], nx[p], centerX);
+				distance = vmlaq_f32(distance, ny[p], centerY);
+				distance = vmlaq_f32(distance, nz[p], centerZ);
+				float32x4_t reach = vmlaq_f32(radius, vabsq_f32(nx[p]), extentX);
+				reach = vmlaq_f32(reach, vabsq_f32(ny[p]), extentY);
+				reach = vmlaq_f32(reach, vabsq_f32(nz[p]), extentZ);
+				outside = vorrq_u32(outside, vcltq_f32(vaddq_f32(distance, reach), vdupq_n_f32(0.0f)));
+			}
+
+			uint32_t lanes[4];
+			vst1q_u32(lanes, outside);
+			for (uint lane = 0; lane < 4; lane++) {
+				if (!lanes[lane] && i + lane < end) {
+					visible.push_back((uint)(i + lane));
+				}
+			}
+		}
+#else
+		for (size_t i = begin; i < end; i++) {
+			bool inside = true;
+			for (uint p = 0; p < Frustum::PlaneCount && inside; p++) {
+				const Plane& plane = frustum.GetPlane(p);
+				const float distance = plane.Distance(m_centerX[i], m_centerY[i], m_centerZ[i]);
+				const float reach = std::fabs(plane.nx) * m_extentX[i] + std::fabs(plane.ny) * m_extentY[i] +
+					std::fabs(plane.nz) * m_extentZ[i] + m_radius[i];
+				inside = distance + reach >= 0.0f;
+			}
+			if (inside) {
+				visible.push_back((uint)i);
+			}
+		}
+#endif
+	}
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <vector>
+#include "types.h"
+#include "Math.h"
+#include "Frustum.h"
+#include "JobSystem.h"
+
+namespace Lumen {
+	// Bounds of many objects in structure-of-arrays form, tested against a Frustum four at a
+	// time with SSE or NEON (whichever the math library was built with, scalar otherwise).
+	// Every entry is a box given by center and half extents plus a radius, so spheres
+	// (zero extents) and boxes (zero radius) share one kernel.
+	// Typical use: keep one entry per renderable, Cull() each frame, then submit only the
+	// returned ids to the RenderQueue or IndirectDrawList.
+	class CullList {
+	public:
+		void Reserve(size_t count);
+		void Clear();
+
+		uint AddAABB(const cx::Vec3& min, const cx::Vec3& max);
+		uint AddSphere(const cx::Vec3& center, float radius);
+		void SetAABB(uint id, const cx::Vec3& min, const cx::Vec3& max);
+		void SetSphere(uint id, const cx::Vec3& center, float radius);
+
+		size_t GetSize() const { return m_count; }
+
+		// Replaces `visible` with the ids of the entries intersecting the frustum, in ascending order.
+		// A job system splits the work across its threads, which only pays off for very large lists
+		uint Cull(const Frustum& frustum, std::vector<uint>& visible, JobSystem *jobs = nullptr) const;
+	private:
+		// padded to a multiple of 4 so the kernel never needs a scalar tail
+		std::vector<float> m_centerX, m_centerY, m_centerZ;
+		std::vector<float> m_extentX, m_extentY, m_extentZ;
+		std::vector<float> m_radius;
+		size_t m_count = 0;
+		mutable std::vector<std::vector<uint>> m_chunkResults;
+	private:
+		uint Append();
+		void CullRange(const Frustum& frustum, size_t begin, size_t end, std::vector<uint>& visible) const;
+	};
+}
@@ -0,0 +1,54 @@
+#include "Frustum.h"
+
+#include <cmath>
+
+namespace Lumen {
+	void Frustum::Extract(const cx::Mat4& viewProjection)
+	{
+		// Gribb/Hartmann: with clip = M * v, -w <= x <= w gives row3 + row0 >= 0 and row3 - row0 >= 0
+		const cx_float *m = viewProjection.data();
+		const cx_float *row3 = m + 12;
+		for (uint i = 0; i < PlaneCount; i++) {
+			const cx_float *row = m + (i / 2) * 4;
+			const float sign = (i % 2) ? -1.0f : 1.0f;
+
+			Plane& plane = m_planes[i];
+			plane.nx = (float)(row3[0] + sign * row[0]);
+			plane.ny = (float)(row3[1] + sign * row[1]);
+			plane.nz = (float)(row3[2] + sign * row[2]);
+			plane.d = (float)(row3[3] + sign * row[3]);
+
+			const float length = std::sqrt(plane.nx * plane.nx + plane.ny * plane.ny + plane.nz * plane.nz);
+			if (length > 0.0f) {
+				plane.nx /= length;
+				plane.ny /= length;
+				plane.nz /= length;
+				plane.d /= length;
+			}
+		}
+	}
+
+	bool Frustum::TestSphere(const cx::Vec3& center, float radius) const
+	{
+		for (const Plane& plane : m_planes) {
+			if (plane.Distance(center.x(), center.y(), center.z()) < -radius) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool Frustum::TestAABB(const cx::Vec3& min, const cx::Vec3& max) const
+	{
+		for (const Plane& plane : m_planes) {
+			// the corner furthest along the plane normal
+			const float x = plane.nx >= 0.0f ? max.x() : min.x();
+			const float y = plane.ny >= 0.0f ? max.y() : min.y();
+			const float z = plane.nz >= 0.0f ? max.z() : min.z();
+			if (plane.Distance(x, y, z) < 0.0f) {
+				return false;
+			}
+		}
+		return true;
+	}
+}
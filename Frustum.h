@@ -0,0 +1,33 @@
+#pragma once
+
+#include "types.h"
+#include "Math.h"
+
+namespace Lumen {
+	// dot(normal, p) + d >= 0 on the inner side
+	struct Plane {
+		float nx = 0.0f, ny = 0.0f, nz = 0.0f, d = 0.0f;
+
+		float Distance(float x, float y, float z) const { return nx * x + ny * y + nz * z + d; }
+	};
+
+	// The six clip planes of a view projection matrix, normalized and pointing inwards.
+	// Built for the engine's column vector, [-1, 1] depth matrices (Camera, perspectiveRH_NO)
+	class Frustum {
+	public:
+		enum PlaneIndex { Left, Right, Bottom, Top, Near, Far, PlaneCount };
+
+		Frustum() = default;
+		explicit Frustum(const cx::Mat4& viewProjection) { Extract(viewProjection); }
+
+		void Extract(const cx::Mat4& viewProjection);
+
+		// Conservative: boxes near a frustum corner may pass although they are outside
+		bool TestSphere(const cx::Vec3& center, float radius) const;
+		bool TestAABB(const cx::Vec3& min, const cx::Vec3& max) const;
+
+		const Plane& GetPlane(uint index) const { return m_planes[index]; }
+	private:
+		Plane m_planes[PlaneCount];
+	};
+}
@@ -0,0 +1,94 @@
+#include "GLExtensions.h"
+
+namespace Lumen {
+	PFNLUMENBUFFERSTORAGEPROC GLExtensions::BufferStorage = nullptr;
+	PFNLUMENMAXSHADERCOMPILERTHREADSPROC GLExtensions::MaxShaderCompilerThreads = nullptr;
+	PFNLUMENGETTEXTUREHANDLEPROC GLExtensions::GetTextureHandle = nullptr;
+	PFNLUMENMAKETEXTUREHANDLERESIDENTPROC GLExtensions::MakeTextureHandleResident = nullptr;
+	PFNLUMENMAKETEXTUREHANDLENONRESIDENTPROC GLExtensions::MakeTextureHandleNonResident = nullptr;
+	PFNLUMENMULTIDRAWELEMENTSINDIRECTPROC GLExtensions::MultiDrawElementsIndirect = nullptr;
+
+	GLADloadproc GLExtensions::m_loader = nullptr;
+	std::unordered_set<std::string> GLExtensions::m_extensions;
+	int GLExtensions::m_major = 0;
+	int GLExtensions::m_minor = 0;
+	bool GLExtensions::m_parallelShaderCompile = false;
+	bool GLExtensions::m_s3tc = false;
+	bool GLExtensions::m_bptc = false;
+
+	void GLExtensions::Load(GLADloadproc loader)
+	{
+		m_loader = loader;
+		m_extensions.clear();
+
+		glGetIntegerv(GL_MAJOR_VERSION, &m_major);
+		glGetIntegerv(GL_MINOR_VERSION, &m_minor);
+
+		int count = 0;
+		glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+		for (int i = 0; i < count; i++) {
+			const char *name = (const char *)glGetStringi(GL_EXTENSIONS, i);
+			if (name) {
+				m_extensions.insert(name);
+			}
+		}
+
+		BufferStorage = (PFNLUMENBUFFERSTORAGEPROC)GetProc("glBufferStorage",
+			IsVersionAtLeast(4, 4) || IsSupported("GL_ARB_buffer_storage"));
+
+		const bool khrParallel = IsSupported("GL_KHR_parallel_shader_compile");
+		const bool arbParallel = IsSupported("GL_ARB_parallel_shader_compile");
+		m_parallelShaderCompile = khrParallel || arbParallel;
+		MaxShaderCompilerThreads = (PFNLUMENMAXSHADERCOMPILERTHREADSPROC)GetProc(
+			khrParallel ? "glMaxShaderCompilerThreadsKHR" : "glMaxShaderCompilerThreadsARB", m_parallelShaderCompile);
+
+		m_s3tc = IsSupported("GL_EXT_texture_compression_s3tc");
+		m_bptc = IsVersionAtLeast(4, 2) || IsSupported("GL_ARB_texture_compression_bptc");
+
+		const bool bindless = IsSupported("GL_ARB_bindless_texture");
+		GetTextureHandle = (PFNLUMENGETTEXTUREHANDLEPROC)GetProc("glGetTextureHandleARB", bindless);
+		MakeTextureHandleResident = (PFNLUMENMAKETEXTUREHANDLERESIDENTPROC)GetProc("glMakeTextureHandleResidentARB", bindless);
+		MakeTextureHandleNonResident = (PFNLUMENMAKETEXTUREHANDLENONRESIDENTPROC)GetProc("glMakeTextureHandleNonResidentARB", bindless);
+
+		const bool baseInstance = IsVersionAtLeast(4, 2) || IsSupported("GL_ARB_base_instance");
+		MultiDrawElementsIndirect = (PFNLUMENMULTIDRAWELEMENTSINDIRECTPROC)GetProc("glMultiDrawElementsIndirect",
+			baseInstance && (IsVersionAtLeast(4, 3) || IsSupported("GL_ARB_multi_draw_indirect")));
+	}
+
+	bool GLExtensions::IsSupported(const std::string& extension)
+	{
+		return m_extensions.find(extension) != m_extensions.end();
+	}
+
+	bool GLExtensions::IsCompressedFormatSupported(GLenum format)
+	{
+		switch (format) {
+			case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+			case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+			case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+			case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:
+			case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT:
+			case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:
+				// the sRGB variants come from EXT_texture_sRGB, which 4.1 drivers with s3tc expose
+				return m_s3tc;
+			case GL_COMPRESSED_RGBA_BPTC_UNORM:
+			case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM:
+				return m_bptc;
+		}
+		return false;
+	}
+
+	bool GLExtensions::IsVersionAtLeast(int major, int minor)
+	{
+		return m_major > major || (m_major == major && m_minor >= minor);
+	}
+
+	void *GLExtensions::GetProc(const char *name, bool available)
+	{
+		// some loaders hand out stubs for anything, only trust what the context advertises
+		if (!available || !m_loader) {
+			return nullptr;
+		}
+		return m_loader(name);
+	}
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <string>
+#include <unordered_set>
+#include <glad/glad.h>
+#include "types.h"
+
+// The bundled glad loader covers core GL 4.1 only. Entry points and enums past that
+// (core 4.2+ or extensions) are declared here and loaded by GLExtensions::Load.
+
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT	0x0040
+#define GL_MAP_COHERENT_BIT		0x0080
+#define GL_DYNAMIC_STORAGE_BIT	0x0100
+#define GL_CLIENT_STORAGE_BIT	0x0200
+#endif
+
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_MAX_SHADER_COMPILER_THREADS_KHR	0x91B0
+#define GL_COMPLETION_STATUS_KHR			0x91B1
+#endif
+
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT			0x83F0
+#define GL_COMPRESSED_RGBA_S3TC_DXT1_EXT		0x83F1
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT		0x83F3
+#endif
+
+#ifndef GL_COMPRESSED_SRGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_SRGB_S3TC_DXT1_EXT		0x8C4C
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT	0x8C4D
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT	0x8C4F
+#endif
+
+#ifndef GL_COMPRESSED_RGBA_BPTC_UNORM
+#define GL_COMPRESSED_RGBA_BPTC_UNORM			0x8E8C
+#define GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM		0x8E8D
+#endif
+
+typedef void (APIENTRYP PFNLUMENBUFFERSTORAGEPROC)(GLenum target, GLsizeiptr size, const void *data, GLbitfield flags);
+typedef void (APIENTRYP PFNLUMENMAXSHADERCOMPILERTHREADSPROC)(GLuint count);
+typedef GLuint64 (APIENTRYP PFNLUMENGETTEXTUREHANDLEPROC)(GLuint texture);
+typedef void (APIENTRYP PFNLUMENMAKETEXTUREHANDLERESIDENTPROC)(GLuint64 handle);
+typedef void (APIENTRYP PFNLUMENMAKETEXTUREHANDLENONRESIDENTPROC)(GLuint64 handle);
+typedef void (APIENTRYP PFNLUMENMULTIDRAWELEMENTSINDIRECTPROC)(GLenum mode, GLenum type, const void *indirect, GLsizei drawcount, GLsizei stride);
+
+namespace Lumen {
+	class GLExtensions {
+	public:
+		// Called by Window once the context is current and glad is loaded
+		static void Load(GLADloadproc loader);
+
+		static bool IsSupported(const std::string& extension);
+		static bool IsVersionAtLeast(int major, int minor);
+		static GLADloadproc GetLoader() { return m_loader; }
+
+		// ARB_buffer_storage / GL 4.4
+		static PFNLUMENBUFFERSTORAGEPROC BufferStorage;
+		static bool HasBufferStorage() { return BufferStorage != nullptr; }
+
+		// KHR_parallel_shader_compile / ARB_parallel_shader_compile. GL_COMPLETION_STATUS_KHR
+		// can be queried whenever this is true; MaxShaderCompilerThreads may still be null
+		static PFNLUMENMAXSHADERCOMPILERTHREADSPROC MaxShaderCompilerThreads;
+		static bool HasParallelShaderCompile() { return m_parallelShaderCompile; }
+
+		// EXT_texture_compression_s3tc (BC1-3), ARB_texture_compression_bptc / GL 4.2 (BC7)
+		static bool HasS3TC() { return m_s3tc; }
+		static bool HasBPTC() { return m_bptc; }
+		// Whether the context can sample the given compressed internal format
+		static bool IsCompressedFormatSupported(GLenum format);
+
+		// ARB_bindless_texture
+		static PFNLUMENGETTEXTUREHANDLEPROC GetTextureHandle;
+		static PFNLUMENMAKETEXTUREHANDLERESIDENTPROC MakeTextureHandleResident;
+		static PFNLUMENMAKETEXTUREHANDLENONRESIDENTPROC MakeTextureHandleNonResident;
+		static bool HasBindlessTexture() { return GetTextureHandle && MakeTextureHandleResident && MakeTextureHandleNonResident; }
+
+		// ARB_multi_draw_indirect / GL 4.3. Only loaded together with ARB_base_instance (GL 4.2),
+		// so the baseInstance field of indirect commands is honoured whenever this is set
+		static PFNLUMENMULTIDRAWELEMENTSINDIRECTPROC MultiDrawElementsIndirect;
+		static bool HasMultiDrawIndirect() { return MultiDrawElementsIndirect != nullptr; }
+	private:
+		static GLADloadproc m_loader;
+		static bool m_parallelShaderCompile;
+		static bool m_s3tc, m_bptc;
+		static std::unordered_set<std::string> m_extensions;
+		static int m_major, m_minor;
+	private:
+		static void *GetProc(const char *name, bool available);
+	};
+}
@@ -0,0 +1,155 @@
+#include "GLState.h"
+
+namespace Lumen {
+	uint GLState::m_program = GLState::Unknown;
+	uint GLState::m_vertexArray = GLState::Unknown;
+	uint GLState::m_arrayBuffer = GLState::Unknown;
+	uint GLState::m_elementBuffer = GLState::Unknown;
+	uint GLState::m_activeSlot = GLState::Unknown;
+	uint GLState::m_textures[GLState::MaxTextureSlots][GLState::TextureTargetCount];
+	GLState::Stats GLState::m_stats;
+
+	void GLState::Invalidate()
+	{
+		m_program = Unknown;
+		m_vertexArray = Unknown;
+		m_arrayBuffer = Unknown;
+		m_elementBuffer = Unknown;
+		m_activeSlot = Unknown;
+		for (auto& slot : m_textures) {
+			for (uint& id : slot) {
+				id = Unknown;
+			}
+		}
+	}
+
+	void GLState::UseProgram(uint id)
+	{
+		if (m_program == id) {
+			m_stats.skipped++;
+			return;
+		}
+		GLCall(glUseProgram(id));
+		m_program = id;
+		m_stats.issued++;
+	}
+
+	void GLState::BindVertexArray(uint id)
+	{
+		if (m_vertexArray == id) {
+			m_stats.skipped++;
+			return;
+		}
+		GLCall(glBindVertexArray(id));
+		m_vertexArray = id;
+		// the element buffer binding is part of the vertex array object
+		m_elementBuffer = Unknown;
+		m_stats.issued++;
+	}
+
+	void GLState::BindBuffer(GLenum target, uint id)
+	{
+		uint *cached = nullptr;
+		if (target == GL_ARRAY_BUFFER) {
+			cached = &m_arrayBuffer;
+		}
+		else if (target == GL_ELEMENT_ARRAY_BUFFER) {
+			cached = &m_elementBuffer;
+		}
+
+		if (cached && *cached == id) {
+			m_stats.skipped++;
+			return;
+		}
+		GLCall(glBindBuffer(target, id));
+		if (cached) {
+			*cached = id;
+		}
+		m_stats.issued++;
+	}
+
+	void GLState::ActiveTexture(uint slot)
+	{
+		if (m_activeSlot == slot) {
+			return;
+		}
+		GLCall(glActiveTexture(GL_TEXTURE0 + slot));
+		m_activeSlot = slot;
+	}
+
+	void GLState::BindTexture(GLenum target, uint id)
+	{
+		const int index = GetTextureTargetIndex(target);
+		if (index < 0 || m_activeSlot >= MaxTextureSlots) {
+			GLCall(glBindTexture(target, id));
+			m_stats.issued++;
+			return;
+		}
+
+		uint& cached = m_textures[m_activeSlot][index];
+		if (cached == id) {
+			m_stats.skipped++;
+			return;
+		}
+		GLCall(glBindTexture(target, id));
+		cached = id;
+		m_stats.issued++;
+	}
+
+	void GLState::BindTexture(GLenum target, uint slot, uint id)
+	{
+		const int index = GetTextureTargetIndex(target);
+		if (index >= 0 && slot < MaxTextureSlots && m_textures[slot][index] == id) {
+			m_stats.skipped++;
+			return;
+		}
+		ActiveTexture(slot);
+		BindTexture(target, id);
+	}
+
+	void GLState::DeleteProgram(uint id)
+	{
+		if (m_program == id) {
+			m_program = 0;
+		}
+	}
+
+	void GLState::DeleteVertexArray(uint id)
+	{
+		if (m_vertexArray == id) {
+			m_vertexArray = 0;
+			m_elementBuffer = Unknown;
+		}
+	}
+
+	void GLState::DeleteBuffer(uint id)
+	{
+		if (m_arrayBuffer == id) {
+			m_arrayBuffer = 0;
+		}
+		if (m_elementBuffer == id) {
+			m_elementBuffer = 0;
+		}
+	}
+
+	void GLState::DeleteTexture(uint id)
+	{
+		for (auto& slot : m_textures) {
+			for (uint& cached : slot) {
+				if (cached == id) {
+					cached = 0;
+				}
+			}
+		}
+	}
+
+	int GLState::GetTextureTargetIndex(GLenum target)
+	{
+		switch (target) {
+			case GL_TEXTURE_2D:			return Texture2D;
+			case GL_TEXTURE_2D_ARRAY:	return Texture2DArray;
+			case GL_TEXTURE_CUBE_MAP:	return TextureCubeMap;
+		}
+		return -1;
+	}
+}
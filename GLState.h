@@ -0,0 +1,52 @@
+#pragma once
+
+#include <glad/glad.h>
+#include "types.h"
+#include "Utils.h"
+
+namespace Lumen {
+	// Shadow copy of the GL binding state for the current context. Every Bind()/Unbind()
+	// in the engine goes through here so binding what is already bound costs no GL call.
+	// Call Invalidate() after GL code outside of Lumen changed bindings behind our back.
+	class GLState {
+	public:
+		static constexpr uint MaxTextureSlots = 32;
+
+		struct Stats {
+			uint issued = 0;
+			uint skipped = 0;
+		};
+
+		static void Invalidate();
+
+		static void UseProgram(uint id);
+		static void BindVertexArray(uint id);
+		// GL_ARRAY_BUFFER and GL_ELEMENT_ARRAY_BUFFER are cached, other targets pass through
+		static void BindBuffer(GLenum target, uint id);
+		static void ActiveTexture(uint slot);
+		static void BindTexture(GLenum target, uint id);
+		static void BindTexture(GLenum target, uint slot, uint id);
+
+		// GL unbinds deleted objects from the current context, mirror that here
+		static void DeleteProgram(uint id);
+		static void DeleteVertexArray(uint id);
+		static void DeleteBuffer(uint id);
+		static void DeleteTexture(uint id);
+
+		static const Stats& GetStats() { return m_stats; }
+		static void ResetStats() { m_stats = Stats(); }
+	private:
+		static constexpr uint Unknown = ~0u;
+		enum TextureTarget { Texture2D, Texture2DArray, TextureCubeMap, TextureTargetCount };
+
+		static uint m_program;
+		static uint m_vertexArray;
+		static uint m_arrayBuffer;
+		static uint m_elementBuffer;
+		static uint m_activeSlot;
+		static uint m_textures[MaxTextureSlots][TextureTargetCount];
+		static Stats m_stats;
+	private:
+		static int GetTextureTargetIndex(GLenum target);
+	};
+}
@@ -0,0 +1,282 @@
+#include "HeadlessWindow.h"
+
+#ifdef LUMEN_HEADLESS
+#include "GLState.h"
+#include "GLExtensions.h"
+
+#include <cstring>
+#include <fstream>
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+namespace Lumen {
+	namespace {
+		bool HasExtension(const char *extensions, const char *name)
+		{
+			if (!extensions) {
+				return false;
+			}
+			const size_t length = std::strlen(name);
+			for (const char *s = std::strstr(extensions, name); s; s = std::strstr(s + 1, name)) {
+				if ((s == extensions || s[-1] == ' ') && (s[length] == ' ' || s[length] == '\0')) {
+					return true;
+				}
+			}
+			return false;
+		}
+
+		void *GetProcAddress(const char *name)
+		{
+			return (void *)eglGetProcAddress(name);
+		}
+	}
+
+	HeadlessWindow::HeadlessWindow(const std::string& title, uint width, uint height, int samples)
+		: m_title(title), m_width(width), m_height(height), m_samples(samples), m_start(std::chrono::steady_clock::now())
+	{
+		// the surfaceless platform needs neither X nor a DRM device, the default display is
+		// the fallback for drivers without it
+		EGLDisplay display = EGL_NO_DISPLAY;
+		const char *clientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+		PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+		if (getPlatformDisplay && HasExtension(clientExtensions, "EGL_MESA_platform_surfaceless")) {
+			display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+		}
+		if (display == EGL_NO_DISPLAY) {
+			display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+		}
+		if (display == EGL_NO_DISPLAY || !eglInitialize(display, nullptr, nullptr)) {
+			std::cerr << "Failed to initialize EGL\n";
+			return;
+		}
+		m_display = display;
+
+		if (!eglBindAPI(EGL_OPENGL_API)) {
+			std::cerr << "EGL: desktop OpenGL is not supported\n";
+			return;
+		}
+
+		const bool surfaceless = HasExtension(eglQueryString(display, EGL_EXTENSIONS), "EGL_KHR_surfaceless_context");
+		const EGLint configAttributes[] = {
+			EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+			EGL_SURFACE_TYPE, surfaceless ? 0 : EGL_PBUFFER_BIT,
+			EGL_RED_SIZE, 8,
+			EGL_GREEN_SIZE, 8,
+			EGL_BLUE_SIZE, 8,
+			EGL_ALPHA_SIZE, 8,
+			EGL_NONE
+		};
+		EGLConfig config = nullptr;
+		EGLint configCount = 0;
+		if (!eglChooseConfig(display, configAttributes, &config, 1, &configCount) || configCount == 0) {
+			std::cerr << "EGL: no suitable config\n";
+			return;
+		}
+
+		const EGLint contextAttributes[] = {
+			EGL_CONTEXT_MAJOR_VERSION_KHR, 4,
+			EGL_CONTEXT_MINOR_VERSION_KHR, 1,
+			EGL_CONTEXT_OPENGL_PROFILE_MASK_KHR, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT_KHR,
+			EGL_NONE
+		};
+		EGLContext context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttributes);
+		if (context == EGL_NO_CONTEXT) {
+			std::cerr << "EGL: failed to create an OpenGL 4.1 core context\n";
+			return;
+		}
+		m_context = context;
+
+		EGLSurface surface = EGL_NO_SURFACE;
+		if (!surfaceless) {
+			// only there to make the context current, rendering goes to the framebuffer
+			const EGLint pbufferAttributes[] = { EGL_WIDTH, 16, EGL_HEIGHT, 16, EGL_NONE };
+			surface = eglCreatePbufferSurface(display, config, pbufferAttributes);
+			if (surface == EGL_NO_SURFACE) {
+				std::cerr << "EGL: failed to create a pbuffer\n";
+				return;
+			}
+			m_surface = surface;
+		}
+		if (!eglMakeCurrent(display, surface, surface, context)) {
+			std::cerr << "EGL: failed to make the context current\n";
+			return;
+		}
+
+		if (!gladLoadGLLoader((GLADloadproc)GetProcAddress)) {
+			std::cerr << "Failed to initialize GLAD\n";
+			return;
+		}
+		GLState::Invalidate();
+		GLExtensions::Load((GLADloadproc)GetProcAddress);
+
+		const char *renderer = (const char *)glGetString(GL_RENDERER);
+		m_renderer = renderer ? renderer : "";
+
+		CreateTargets();
+	}
+
+	HeadlessWindow::~HeadlessWindow()
+	{
+		if (!m_display) {
+			return;
+		}
+		if (m_context) {
+			DestroyTargets();
+			eglMakeCurrent(m_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+			eglDestroyContext(m_display, m_context);
+		}
+		if (m_surface) {
+			eglDestroySurface(m_display, m_surface);
+		}
+		eglTerminate(m_display);
+	}
+
+	void HeadlessWindow::CreateTargets()
+	{
+		m_colorTexture = 0;
+		GLCall(glGenTextures(1, &m_colorTexture));
+		GLState::BindTexture(GL_TEXTURE_2D, m_colorTexture);
+		GLCall(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, m_width, m_height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr));
+		GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
+		GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+
+		GLCall(glGenFramebuffers(1, &m_framebuffer));
+		GLCall(glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer));
+		GLCall(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_colorTexture, 0));
+
+		// depth goes with whichever framebuffer is rendered to
+		if (m_samples > 0) {
+			GLCall(glGenRenderbuffers(1, &m_msColor));
+			GLCall(glBindRenderbuffer(GL_RENDERBUFFER, m_msColor));
+			GLCall(glRenderbufferStorageMultisample(GL_RENDERBUFFER, m_samples, GL_RGBA8, m_width, m_height));
+
+			GLCall(glGenFramebuffers(1, &m_msFramebuffer));
+			GLCall(glBindFramebuffer(GL_FRAMEBUFFER, m_msFramebuffer));
+			GLCall(glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_msColor));
+		}
+
+		GLCall(glGenRenderbuffers(1, &m_depthStencil));
+		GLCall(glBindRenderbuffer(GL_RENDERBUFFER, m_depthStencil));
+		if (m_samples > 0) {
+			GLCall(glRenderbufferStorageMultisample(GL_RENDERBUFFER, m_samples, GL_DEPTH24_STENCIL8, m_width, m_height));
+		}
+		else {
+			GLCall(glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, m_width, m_height));
+		}
+		GLCall(glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, m_depthStencil));
+
+		if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+			std::cerr << "HeadlessWindow: incomplete framebuffer (" << m_width << "x" << m_height << ", " << m_samples << " samples)\n";
+		}
+		GLCall(glViewport(0, 0, m_width, m_height));
+	}
+
+	void HeadlessWindow::DestroyTargets()
+	{
+		GLCall(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+		const uint framebuffers[2] = { m_framebuffer, m_msFramebuffer };
+		const uint renderbuffers[2] = { m_depthStencil, m_msColor };
+		GLCall(glDeleteFramebuffers(2, framebuffers));
+		GLCall(glDeleteRenderbuffers(2, renderbuffers));
+		GLCall(glDeleteTextures(1, &m_colorTexture));
+		GLState::DeleteTexture(m_colorTexture);
+		m_framebuffer = m_msFramebuffer = 0;
+		m_depthStencil = m_msColor = 0;
+		m_colorTexture = 0;
+	}
+
+	void HeadlessWindow::Resize(uint width, uint height)
+	{
+		if (!IsValid() || (width == m_width && height == m_height)) {
+			return;
+		}
+		DestroyTargets();
+		m_width = width;
+		m_height = height;
+		CreateTargets();
+	}
+
+	void HeadlessWindow::SwapBuffers()
+	{
+#ifdef LUMEN_DEBUG
+		if (GLErrorCheckMode() == GLErrorCheck::PerFrame) {
+			GLCheckErrors("frame");
+		}
+#endif
+		if (m_msFramebuffer) {
+			GLCall(glBindFramebuffer(GL_READ_FRAMEBUFFER, m_msFramebuffer));
+			GLCall(glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_framebuffer));
+			GLCall(glBlitFramebuffer(0, 0, m_width, m_height, 0, 0, m_width, m_height, GL_COLOR_BUFFER_BIT, GL_NEAREST));
+		}
+		// nothing presents the frame, flushing keeps the driver from queueing frames forever
+		GLCall(glFlush());
+		GLCall(glBindFramebuffer(GL_FRAMEBUFFER, GetFramebuffer()));
+
+		if (m_frameLimit && ++m_frame >= m_frameLimit) {
+			m_shouldClose = true;
+		}
+	}
+
+	float HeadlessWindow::GetTime() const
+	{
+		return std::chrono::duration<float>(std::chrono::steady_clock::now() - m_start).count();
+	}
+
+	float HeadlessWindow::GetFrameTime()
+	{
+		float currentTime = GetTime();
+		m_deltaTime = currentTime - m_lastTime;
+		m_lastTime = currentTime;
+		return m_deltaTime;
+	}
+
+	float HeadlessWindow::GetFPS() const
+	{
+		return 1.0 / m_deltaTime;
+	}
+
+	void HeadlessWindow::ReadPixels(unsigned char *rgba, bool flipY) const
+	{
+		// always the resolved framebuffer, a multisampled one cannot be read directly
+		GLCall(glBindFramebuffer(GL_READ_FRAMEBUFFER, m_framebuffer));
+		GLCall(glPixelStorei(GL_PACK_ALIGNMENT, 1));
+		GLCall(glReadPixels(0, 0, m_width, m_height, GL_RGBA, GL_UNSIGNED_BYTE, rgba));
+		GLCall(glBindFramebuffer(GL_READ_FRAMEBUFFER, GetFramebuffer()));
+
+		if (flipY) {
+			// GL's first row is the bottom one
+			const size_t pitch = (size_t)m_width * 4;
+			std::vector<unsigned char> row(pitch);
+			for (uint y = 0; y < m_height / 2; y++) {
+				unsigned char *top = rgba + y * pitch;
+				unsigned char *bottom = rgba + (m_height - 1 - y) * pitch;
+				std::memcpy(row.data(), top, pitch);
+				std::memcpy(top, bottom, pitch);
+				std::memcpy(bottom, row.data(), pitch);
+			}
+		}
+	}
+
+	std::vector<unsigned char> HeadlessWindow::ReadPixels() const
+	{
+		std::vector<unsigned char> pixels((size_t)m_width * m_height * 4);
+		ReadPixels(pixels.data());
+		return pixels;
+	}
+
+	bool HeadlessWindow::SaveImage(const std::string& path) const
+	{
+		const std::vector<unsigned char> pixels = ReadPixels();
+		std::ofstream out(path, std::ios::binary | std::ios::trunc);
+		if (!out) {
+			std::cerr << "HeadlessWindow: cannot write " << path << std::endl;
+			return false;
+		}
+		out << "P6\n" << m_width << " " << m_height << "\n255\n";
+		for (size_t i = 0; i < pixels.size(); i += 4) {
+			out.write((const char *)&pixels[i], 3);
+		}
+		return (bool)out;
+	}
+}
+#endif
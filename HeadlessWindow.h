@@ -0,0 +1,92 @@
+#pragma once
+
+// EGL is only assumed on Linux, other platforms that have it opt in with LUMEN_HEADLESS
+#if defined(__linux__) && !defined(LUMEN_HEADLESS)
+#define LUMEN_HEADLESS
+#endif
+
+#ifdef LUMEN_HEADLESS
+#include <string>
+#include <vector>
+#include <chrono>
+#include <glad/glad.h>
+#include "types.h"
+#include "Utils.h"
+
+namespace Lumen {
+	// Window stand in for machines without a display (CI, benchmark boxes): an EGL context
+	// on the surfaceless platform, or a pbuffer when that is missing, rendering into an
+	// offscreen framebuffer. Runs on Mesa llvmpipe with LIBGL_ALWAYS_SOFTWARE=1 or
+	// EGL_PLATFORM=surfaceless. Link with -lEGL.
+	// There is no default framebuffer: code that renders to the screen must bind
+	// GetFramebuffer() instead of 0, SwapBuffers() rebinds it.
+	class HeadlessWindow {
+	public:
+		HeadlessWindow(const std::string& title, uint width = 1280, uint height = 720, int samples = 0);
+		~HeadlessWindow();
+
+		HeadlessWindow(const HeadlessWindow&) = delete;
+		HeadlessWindow& operator=(const HeadlessWindow&) = delete;
+
+		// Matches Window::Init, nothing to do without GLFW
+		static int Init() { return 0; }
+		bool IsValid() const { return m_framebuffer != 0; }
+
+		// Resolves multisampling, finishes the frame and rebinds the framebuffer
+		void SwapBuffers();
+		void SwapInterval(bool enabled = true) const { (void)enabled; }
+		void SetVsync(bool enabled = true) const { (void)enabled; }
+		void PollEvents() const {}
+
+		// Closes after `frames` more SwapBuffers, 0 never does
+		void SetFrameLimit(uint frames) { m_frameLimit = frames; m_frame = 0; }
+		void SetShouldClose(bool close) { m_shouldClose = close; }
+		bool ShouldClose() const { return m_shouldClose; }
+
+		// Recreates the attachments, the content is lost
+		void Resize(uint width, uint height);
+
+		// What to render to, the multisampled framebuffer when there is one
+		uint GetFramebuffer() const { return m_msFramebuffer ? m_msFramebuffer : m_framebuffer; }
+		// Single sampled result, valid after SwapBuffers
+		uint GetColorTexture() const { return m_colorTexture; }
+		uint GetWidth() const { return m_width; }
+		uint GetHeight() const { return m_height; }
+		float GetTime() const;
+		float GetFrameTime();
+		float GetFPS() const;
+		const std::string& GetRenderer() const { return m_renderer; }
+
+		// Color of the last finished frame as tightly packed RGBA8 rows, top row first
+		std::vector<unsigned char> ReadPixels() const;
+		void ReadPixels(unsigned char *rgba, bool flipY = true) const;
+		// Binary PPM (the alpha channel is dropped), enough for golden images and diffs
+		bool SaveImage(const std::string& path) const;
+	private:
+		void CreateTargets();
+		void DestroyTargets();
+	private:
+		std::string m_title;
+		uint m_width, m_height;
+		int m_samples;
+
+		void *m_display = nullptr;		// EGLDisplay
+		void *m_context = nullptr;		// EGLContext
+		void *m_surface = nullptr;		// EGLSurface, only without surfaceless contexts
+
+		uint m_framebuffer = 0;
+		uint m_colorTexture = 0;
+		uint m_depthStencil = 0;
+		uint m_msFramebuffer = 0;		// rendered to when multisampled, resolved into m_framebuffer
+		uint m_msColor = 0;
+
+		uint m_frameLimit = 0;
+		uint m_frame = 0;
+		bool m_shouldClose = false;
+		std::chrono::steady_clock::time_point m_start;
+		float m_lastTime = 0.0;
+		float m_deltaTime = 0.0;
+		std::string m_renderer;
+	};
+}
+#endif
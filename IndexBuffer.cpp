@@ -1,18 +1,26 @@
 #include "IndexBuffer.h"
 
 namespace Lumen {
-	IndexBuffer::IndexBuffer(const void *data, uint size, GLenum usage)
-		: m_id(0), m_size(size)
+	IndexBuffer::IndexBuffer(const void *data, uint size, GLenum usage, GLenum type)
+		: m_size(size), m_id(0), m_type(type)
 	{
 		GLCall(glGenBuffers(1, &m_id));
-		GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_id));
+		GLState::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_id);
 		GLCall(glBufferData(GL_ELEMENT_ARRAY_BUFFER, size, data, usage));
-		GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
+		GLState::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 	}
 
 	IndexBuffer::~IndexBuffer()
 	{
 		GLCall(glDeleteBuffers(1, &m_id));
+		GLState::DeleteBuffer(m_id);
+	}
+
+	void IndexBuffer::SetSubData(const void *data, uint size, uint offset)
+	{
+		// the element binding belongs to whichever vertex array is bound, go through the copy target
+		GLState::BindBuffer(GL_COPY_WRITE_BUFFER, m_id);
+		GLCall(glBufferSubData(GL_COPY_WRITE_BUFFER, offset, size, data));
 	}
 
 	uint IndexBuffer::GetSize() const
@@ -22,11 +30,11 @@ namespace Lumen {
 
 	void IndexBuffer::Bind() const
 	{
-		GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_id));
+		GLState::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_id);
 	}
 
 	void IndexBuffer::Unbind() const
 	{
-		GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
+		GLState::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 	}
 }
@@ -3,18 +3,28 @@
 #include "types.h"
 #include <glad/glad.h>
 #include "Utils.h"
+#include "GLState.h"
 
 namespace Lumen {
 	class IndexBuffer {
 	public:
-		IndexBuffer(const void *data, uint size, GLenum usage = GL_STATIC_DRAW);
+		// `size` is in bytes, `type` is GL_UNSIGNED_INT, GL_UNSIGNED_SHORT or GL_UNSIGNED_BYTE
+		IndexBuffer(const void *data, uint size, GLenum usage = GL_STATIC_DRAW, GLenum type = GL_UNSIGNED_INT);
 		~IndexBuffer();
 
+		// Safe to call with any vertex array bound
+		void SetSubData(const void *data, uint size, uint offset = 0);
+
 		uint GetSize() const;
+		uint GetCount() const { return m_size / GetTypeSize(m_type); }
+		GLenum GetType() const { return m_type; }
 		void Bind() const;
 		void Unbind() const;
+
+		static uint GetTypeSize(GLenum type) { return type == GL_UNSIGNED_SHORT ? 2 : type == GL_UNSIGNED_BYTE ? 1 : 4; }
 	private:
 		uint m_size;
 		uint m_id;
+		GLenum m_type;
 	};
 }
@@ -0,0 +1,73 @@
+#include "IndirectDrawList.h"
+
+#include <cstring>
+
+namespace Lumen {
+	IndirectDrawList::IndirectDrawList(uint maxCommands, uint framesInFlight)
+		: m_maxCommands(maxCommands),
+		m_commandStream(GL_DRAW_INDIRECT_BUFFER, maxCommands * (uint)sizeof(DrawElementsIndirectCommand), framesInFlight)
+	{
+		m_commands.reserve(maxCommands);
+	}
+
+	uint IndirectDrawList::Add(const MeshRange& range, uint instanceCount)
+	{
+		if (m_commands.size() >= m_maxCommands) {
+			std::cerr << "IndirectDrawList: more than " << m_maxCommands << " commands" << std::endl;
+			return ~0u;
+		}
+
+		DrawElementsIndirectCommand command;
+		command.count = range.indexCount;
+		command.instanceCount = instanceCount;
+		command.firstIndex = range.firstIndex;
+		command.baseVertex = range.baseVertex;
+		command.baseInstance = m_instanceCount;
+		m_commands.push_back(command);
+
+		m_instanceCount += instanceCount;
+		return command.baseInstance;
+	}
+
+	void IndirectDrawList::Clear()
+	{
+		m_commands.clear();
+		m_instanceCount = 0;
+	}
+
+	void IndirectDrawList::Draw(MeshBuffer& meshes, int mode)
+	{
+		if (m_commands.empty()) {
+			return;
+		}
+		if (m_instanceCount > meshes.GetMaxInstances()) {
+			std::cerr << "IndirectDrawList: " << m_instanceCount << " instances, the mesh buffer has draw indices for " << meshes.GetMaxInstances() << std::endl;
+			Clear();
+			return;
+		}
+
+		meshes.Bind();
+
+		if (GLExtensions::HasMultiDrawIndirect()) {
+			const uint count = (uint)m_commands.size();
+			StreamBuffer::Span<DrawElementsIndirectCommand> span = m_commandStream.Allocate<DrawElementsIndirectCommand>(count, 4);
+			if (span) {
+				std::memcpy(span.data, m_commands.data(), count * sizeof(DrawElementsIndirectCommand));
+				m_commandStream.Commit();
+				m_commandStream.Bind();
+				Renderer::MultiDrawIndexedIndirect(count, span.offset, mode, GL_UNSIGNED_INT);
+				Clear();
+				return;
+			}
+		}
+
+		// no base instance either, so the draw index attribute is re-pointed per command
+		for (const DrawElementsIndirectCommand& command : m_commands) {
+			meshes.SetDrawIndexBase(command.baseInstance);
+			Renderer::DrawIndexedInstanced(command.count, command.firstIndex * (uint)sizeof(uint), command.baseVertex,
+				command.instanceCount, mode, GL_UNSIGNED_INT);
+		}
+		meshes.SetDrawIndexBase(0);
+		Clear();
+	}
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <vector>
+#include <glad/glad.h>
+#include "types.h"
+#include "MeshBuffer.h"
+#include "StreamBuffer.h"
+#include "Renderer.h"
+
+namespace Lumen {
+	// Layout glMultiDrawElementsIndirect reads from GL_DRAW_INDIRECT_BUFFER
+	struct DrawElementsIndirectCommand {
+		uint count;
+		uint instanceCount;
+		uint firstIndex;
+		int baseVertex;
+		uint baseInstance;
+	};
+
+	// Per-frame list of draws out of one MeshBuffer, submitted with a single
+	// glMultiDrawElementsIndirect, so the CPU cost no longer grows with the object count.
+	// Every instance gets a consecutive draw index (the a_DrawIndex attribute of MeshBuffer),
+	// which shaders use to fetch per-object data such as transforms or TextureTable slots.
+	// Commands are written on the CPU into a StreamBuffer; without multi-draw indirect
+	// (GL 4.1 contexts) Draw() falls back to one instanced draw per command.
+	class IndirectDrawList {
+	public:
+		IndirectDrawList(uint maxCommands = 4096, uint framesInFlight = 3);
+
+		IndirectDrawList(const IndirectDrawList&) = delete;
+		IndirectDrawList& operator=(const IndirectDrawList&) = delete;
+
+		// Returns the draw index of the first instance, ~0u when the list or the instance
+		// range is full. Instances of this command use the following indices
+		uint Add(const MeshRange& range, uint instanceCount = 1);
+		void Clear();
+
+		// Draws everything added since the last Draw() with the currently bound program, then clears
+		void Draw(MeshBuffer& meshes, int mode = GL_TRIANGLES);
+		// Once per frame, after the last Draw()
+		void EndFrame() { m_commandStream.EndFrame(); }
+
+		uint GetCommandCount() const { return (uint)m_commands.size(); }
+		uint GetInstanceCount() const { return m_instanceCount; }
+	private:
+		uint m_maxCommands;
+		uint m_instanceCount = 0;
+		std::vector<DrawElementsIndirectCommand> m_commands;
+		StreamBuffer m_commandStream;
+	};
+}
@@ -0,0 +1,305 @@
+#include "JobSystem.h"
+#include "Profiler.h"
+
+#include <algorithm>
+
+namespace Lumen {
+	namespace {
+		thread_local const JobSystem *t_system = nullptr;
+		thread_local uint t_index = ~0u;
+	}
+
+	bool JobSystem::Deque::Push(Job *job)
+	{
+		const int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+		const int64_t top = m_top.load(std::memory_order_acquire);
+		if (bottom - top >= (int64_t)DequeCapacity) {
+			return false;
+		}
+		m_buffer[bottom % DequeCapacity].store(job, std::memory_order_relaxed);
+		m_bottom.store(bottom + 1, std::memory_order_release);
+		return true;
+	}
+
+	JobSystem::Job *JobSystem::Deque::Pop()
+	{
+		const int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+		// the reservation of the bottom slot must be visible before top is read, or a thief
+		// and the owner could both take the last job
+		m_bottom.store(bottom, std::memory_order_seq_cst);
+		int64_t top = m_top.load(std::memory_order_seq_cst);
+
+		if (top > bottom) {
+			m_bottom.store(bottom + 1, std::memory_order_relaxed);
+			return nullptr;
+		}
+		Job *job = m_buffer[bottom % DequeCapacity].load(std::memory_order_relaxed);
+		if (top == bottom) {
+			// last job, race the thieves for it
+			if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+				job = nullptr;
+			}
+			m_bottom.store(bottom + 1, std::memory_order_relaxed);
+		}
+		return job;
+	}
+
+	JobSystem::Job *JobSystem::Deque::Steal()
+	{
+		int64_t top = m_top.load(std::memory_order_seq_cst);
+		const int64_t bottom = m_bottom.load(std::memory_order_seq_cst);
+		if (top >= bottom) {
+			return nullptr;
+		}
+		Job *job = m_buffer[top % DequeCapacity].load(std::memory_order_relaxed);
+		if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+			return nullptr;
+		}
+		return job;
+	}
+
+	JobSystem::JobSystem(uint threadCount)
+	{
+		threadCount = std::max(threadCount, 1u);
+		for (uint i = 0; i < threadCount; i++) {
+			m_deques.emplace_back(new Deque());
+		}
+
+		t_system = this;
+		t_index = 0;
+		for (uint i = 1; i < threadCount; i++) {
+			m_workers.emplace_back(&JobSystem::WorkerLoop, this, i);
+		}
+	}
+
+	JobSystem::~JobSystem()
+	{
+		m_stop.store(true);
+		{
+			std::lock_guard<std::mutex> lock(m_sleepMutex);
+		}
+		m_wake.notify_all();
+		for (auto& worker : m_workers) {
+			worker.join();
+		}
+
+		// jobs nobody waited for are dropped
+		for (auto& deque : m_deques) {
+			while (Job *job = deque->Steal()) {
+				delete job;
+			}
+		}
+		for (Job *job : m_injected) {
+			delete job;
+		}
+		for (Job *job : m_background) {
+			delete job;
+		}
+		if (t_system == this) {
+			t_system = nullptr;
+			t_index = ~0u;
+		}
+	}
+
+	uint JobSystem::GetThreadIndex() const
+	{
+		return t_system == this ? t_index : ~0u;
+	}
+
+	void JobSystem::Run(std::function<void()> function, JobCounter *signal, JobCounter *waitFor)
+	{
+		Job *job = new Job { std::move(function), signal, false };
+		if (signal) {
+			signal->m_pending.fetch_add(1, std::memory_order_relaxed);
+		}
+		if (waitFor) {
+			std::lock_guard<std::mutex> lock(waitFor->m_mutex);
+			if (!waitFor->IsDone()) {
+				waitFor->m_waiting.push_back(job);
+				return;
+			}
+		}
+		Schedule(job);
+	}
+
+	void JobSystem::RunBackground(std::function<void()> function, JobCounter *signal)
+	{
+		if (m_workers.empty()) {
+			function();
+			return;
+		}
+
+		Job *job = new Job { std::move(function), signal, true };
+		if (signal) {
+			signal->m_pending.fetch_add(1, std::memory_order_relaxed);
+		}
+		Schedule(job);
+	}
+
+	void JobSystem::Schedule(Job *job)
+	{
+		m_queued.fetch_add(1);
+
+		const uint index = GetThreadIndex();
+		if (job->background) {
+			std::lock_guard<std::mutex> lock(m_injectMutex);
+			m_background.push_back(job);
+		}
+		else if (index == ~0u) {
+			std::lock_guard<std::mutex> lock(m_injectMutex);
+			m_injected.push_back(job);
+		}
+		else if (!m_deques[index]->Push(job)) {
+			m_queued.fetch_sub(1);
+			Execute(job);
+			return;
+		}
+
+		// pairs with the m_sleeping increment in WorkerLoop, one of the two sides sees the other
+		if (m_sleeping.load() > 0) {
+			{
+				std::lock_guard<std::mutex> lock(m_sleepMutex);
+			}
+			m_wake.notify_one();
+		}
+	}
+
+	JobSystem::Job *JobSystem::Find(uint index, bool background)
+	{
+		Job *job = nullptr;
+		if (index != ~0u) {
+			job = m_deques[index]->Pop();
+		}
+
+		// steal from the others, starting at the next thread so thieves spread out
+		const uint count = (uint)m_deques.size();
+		const uint start = index == ~0u ? 0 : index + 1;
+		for (uint i = 0; i < count && !job; i++) {
+			const uint victim = (start + i) % count;
+			if (victim != index) {
+				job = m_deques[victim]->Steal();
+			}
+		}
+
+		if (!job) {
+			std::lock_guard<std::mutex> lock(m_injectMutex);
+			if (!m_injected.empty()) {
+				job = m_injected.front();
+				m_injected.pop_front();
+			}
+			else if (background && !m_background.empty()) {
+				job = m_background.front();
+				m_background.pop_front();
+			}
+		}
+
+		if (job) {
+			m_queued.fetch_sub(1, std::memory_order_relaxed);
+		}
+		return job;
+	}
+
+	void JobSystem::Execute(Job *job)
+	{
+		job->function();
+		Finish(job->signal);
+		delete job;
+	}
+
+	void JobSystem::Finish(JobCounter *counter)
+	{
+		if (!counter) {
+			return;
+		}
+
+		// Wait() holds on until m_finishing is back to zero, so the counter can be destroyed as
+		// soon as it returns even though this thread still touches it after the decrement.
+		// Dependent jobs are only scheduled once the counter is left alone: they may be what
+		// someone waits on before destroying it
+		std::vector<void *> ready;
+		counter->m_finishing.fetch_add(1, std::memory_order_acq_rel);
+		if (counter->m_pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+			std::lock_guard<std::mutex> lock(counter->m_mutex);
+			ready.swap(counter->m_waiting);
+		}
+		counter->m_finishing.fetch_sub(1, std::memory_order_release);
+
+		for (void *job : ready) {
+			Schedule(static_cast<Job *>(job));
+		}
+	}
+
+	void JobSystem::Wait(JobCounter& counter)
+	{
+		const uint index = GetThreadIndex();
+		while (!counter.IsDone()) {
+			if (Job *job = Find(index, false)) {
+				Execute(job);
+			}
+			else {
+				std::this_thread::yield();
+			}
+		}
+		while (counter.m_finishing.load(std::memory_order_acquire) != 0) {
+			std::this_thread::yield();
+		}
+	}
+
+	void JobSystem::ParallelFor(size_t count, size_t grain, const std::function<void(size_t begin, size_t end)>& func, JobCounter& signal)
+	{
+		if (grain == 0) {
+			grain = 1;
+		}
+		const std::function<void(size_t, size_t)> *function = &func;
+		for (size_t begin = 0; begin < count; begin += grain) {
+			const size_t end = std::min(begin + grain, count);
+			Run([function, begin, end] { (*function)(begin, end); }, &signal);
+		}
+	}
+
+	void JobSystem::ParallelFor(size_t count, size_t grain, const std::function<void(size_t begin, size_t end)>& func)
+	{
+		if (count == 0) {
+			return;
+		}
+		if (grain == 0) {
+			grain = 1;
+		}
+		if (m_deques.size() == 1 || count <= grain) {
+			func(0, count);
+			return;
+		}
+
+		JobCounter counter;
+		ParallelFor(count, grain, func, counter);
+		Wait(counter);
+	}
+
+	void JobSystem::WorkerLoop(uint index)
+	{
+		LUMEN_PROFILE_THREAD("Job Worker");
+		t_system = this;
+		t_index = index;
+
+		uint idle = 0;
+		while (!m_stop.load(std::memory_order_relaxed)) {
+			// frame jobs first, background ones only when there are none
+			if (Job *job = Find(index, true)) {
+				Execute(job);
+				idle = 0;
+				continue;
+			}
+			// a short spin catches the next batch of a frame without a sleep and wake up
+			if (++idle < 64) {
+				std::this_thread::yield();
+				continue;
+			}
+
+			std::unique_lock<std::mutex> lock(m_sleepMutex);
+			m_sleeping.fetch_add(1);
+			m_wake.wait(lock, [this] { return m_stop.load() || m_queued.load() > 0; });
+			m_sleeping.fetch_sub(1);
+			idle = 0;
+		}
+	}
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <mutex>
+#include <deque>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <functional>
+#include <condition_variable>
+#include "types.h"
+
+namespace Lumen {
+	class JobSystem;
+
+	// Tracks a group of jobs: every job run with this counter as its signal adds one, and
+	// finishing takes it off again. Jobs can also wait on a counter, they are only queued
+	// once it reaches zero. A counter must outlive the jobs that reference it; once Wait()
+	// returned on it, it can go
+	class JobCounter {
+	public:
+		JobCounter() = default;
+		JobCounter(const JobCounter&) = delete;
+		JobCounter& operator=(const JobCounter&) = delete;
+
+		bool IsDone() const { return m_pending.load(std::memory_order_acquire) == 0; }
+		uint GetPending() const { return m_pending.load(std::memory_order_acquire); }
+	private:
+		friend class JobSystem;
+
+		std::atomic<uint> m_pending { 0 };
+		std::atomic<uint> m_finishing { 0 };	// jobs between their decrement and their last access
+		std::mutex m_mutex;				// guards m_waiting
+		std::vector<void *> m_waiting;	// JobSystem::Job, queued when m_pending drops to zero
+	};
+
+	// Work stealing scheduler. Every thread owns a Chase-Lev deque: it pushes and pops its own
+	// jobs at the bottom without locking while idle threads steal from the top. The thread
+	// that creates the system is thread 0 and takes part whenever it waits; jobs submitted
+	// from any other thread go through a shared queue.
+	// Jobs run in no particular order and must not block on each other except through Wait(),
+	// which keeps executing jobs until its counter is done. Long jobs (file loading, decoding)
+	// go through RunBackground() so that a Wait() inside a frame never picks one up.
+	class JobSystem {
+	public:
+		static const uint DequeCapacity = 4096;		// per thread, a full deque runs new jobs inline
+
+		// threadCount counts the calling thread
+		JobSystem(uint threadCount = std::thread::hardware_concurrency());
+		~JobSystem();
+
+		JobSystem(const JobSystem&) = delete;
+		JobSystem& operator=(const JobSystem&) = delete;
+
+		// `signal` is done once the job ran, `waitFor` holds the job back until it is done
+		void Run(std::function<void()> job, JobCounter *signal = nullptr, JobCounter *waitFor = nullptr);
+		// Queued for the worker threads only, Wait() leaves these alone. Runs inline when the
+		// system has no workers. Background jobs cannot wait on a counter
+		void RunBackground(std::function<void()> job, JobCounter *signal = nullptr);
+		// Executes jobs until `counter` is done
+		void Wait(JobCounter& counter);
+
+		// Splits [0, count) into chunks of `grain` and blocks until func ran on all of them
+		void ParallelFor(size_t count, size_t grain, const std::function<void(size_t begin, size_t end)>& func);
+		// Same, without blocking: `signal` is done once every chunk ran. `func` must stay alive
+		// until then
+		void ParallelFor(size_t count, size_t grain, const std::function<void(size_t begin, size_t end)>& func, JobCounter& signal);
+
+		uint GetThreadCount() const { return (uint)m_deques.size(); }
+		// Index of the calling thread in this system, ~0u for threads that are not part of it
+		uint GetThreadIndex() const;
+	private:
+		struct Job {
+			std::function<void()> function;
+			JobCounter *signal;
+			bool background;
+		};
+
+		// Chase-Lev deque after Le et al., "Correct and Efficient Work-Stealing for Weak Memory
+		// Models" (2013), with their seq_cst fences folded into seq_cst accesses of top and
+		// bottom. Fixed capacity, Push fails when full
+		class Deque {
+		public:
+			bool Push(Job *job);
+			Job *Pop();		// owner only
+			Job *Steal();	// any thread
+		private:
+			alignas(64) std::atomic<int64_t> m_top { 0 };
+			alignas(64) std::atomic<int64_t> m_bottom { 0 };
+			std::atomic<Job *> m_buffer[DequeCapacity];
+		};
+
+		std::vector<std::unique_ptr<Deque>> m_deques;
+		std::vector<std::thread> m_workers;
+
+		std::mutex m_injectMutex;
+		std::deque<Job *> m_injected;		// jobs from threads outside the system
+		std::deque<Job *> m_background;		// guarded by m_injectMutex as well
+
+		std::mutex m_sleepMutex;
+		std::condition_variable m_wake;
+		std::atomic<uint> m_queued { 0 };	// jobs pushed and not yet taken
+		std::atomic<uint> m_sleeping { 0 };
+		std::atomic<bool> m_stop { false };
+	private:
+		void WorkerLoop(uint index);
+		void Schedule(Job *job);
+		Job *Find(uint index, bool background);
+		void Execute(Job *job);
+		void Finish(JobCounter *counter);
+	};
+}
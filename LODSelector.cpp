@@ -0,0 +1,86 @@
+#include "LODSelector.h"
+
+#include <cmath>
+#include <algorithm>
+
+namespace Lumen {
+	LODSelector::LODSelector(float pixelError, float hysteresis)
+		: m_pixelError(pixelError), m_hysteresis(hysteresis)
+	{
+	}
+
+	void LODSelector::Begin(const Camera& camera, float viewportHeight)
+	{
+		// the projection's y scale is cot(fov / 2) for perspective and 2 / (top - bottom) for
+		// orthographic, half the viewport maps to one unit of clip space either way
+		const cx_float *projection = camera.GetProjectionMatrix().data();
+		m_pixelsPerUnit = (float)projection[5] * viewportHeight * 0.5f;
+		m_perspective = camera.GetProjectionType() == ProjectionType::PERSPECTIVE;
+		m_position = camera.GetPosition();
+		m_stats = Stats();
+	}
+
+	float LODSelector::GetProjectedSize(const cx::Vec3& center, float size) const
+	{
+		if (!m_perspective) {
+			return size * m_pixelsPerUnit;
+		}
+		const float dx = center.x() - m_position.x();
+		const float dy = center.y() - m_position.y();
+		const float dz = center.z() - m_position.z();
+		const float distance = std::sqrt(dx * dx + dy * dy + dz * dz);
+		return size * m_pixelsPerUnit / std::max(distance, 1e-3f);
+	}
+
+	uint LODSelector::Select(const cx::Vec3& center, float radius, const float *errors, uint levelCount, uint& level)
+	{
+		if (levelCount == 0) {
+			return level = 0;
+		}
+
+		// measure from the nearest point of the bounding sphere, so large objects refine
+		// before the camera gets inside them
+		float scale = m_pixelsPerUnit;
+		if (m_perspective) {
+			const float dx = center.x() - m_position.x();
+			const float dy = center.y() - m_position.y();
+			const float dz = center.z() - m_position.z();
+			const float distance = std::sqrt(dx * dx + dy * dy + dz * dz) - radius;
+			scale = distance > 1e-3f ? m_pixelsPerUnit / distance : 1e30f;
+		}
+
+		const uint previous = std::min(level, levelCount - 1);
+		uint selected = 0;
+		for (uint i = levelCount; i-- > 1;) {
+			// moving to a coarser level needs some margin below the threshold, staying on the
+			// current one is allowed up to some margin above it
+			float threshold = m_pixelError;
+			if (i > previous) {
+				threshold *= 1.0f - m_hysteresis;
+			}
+			else if (i == previous) {
+				threshold *= 1.0f + m_hysteresis;
+			}
+			if (errors[i] * scale <= threshold) {
+				selected = i;
+				break;
+			}
+		}
+
+		if (selected != level) {
+			m_stats.switches++;
+		}
+		m_stats.objects++;
+		m_stats.levels[std::min(selected, 7u)]++;
+		return level = selected;
+	}
+
+	uint LODSelector::Select(const cx::Vec3& center, float radius, const std::vector<MeshLOD>& chain, uint& level)
+	{
+		m_errors.resize(chain.size());
+		for (size_t i = 0; i < chain.size(); i++) {
+			m_errors[i] = chain[i].error;
+		}
+		return Select(center, radius, m_errors.data(), (uint)m_errors.size(), level);
+	}
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <vector>
+#include "types.h"
+#include "Math.h"
+#include "Camera.h"
+#include "MeshSimplifier.h"
+
+namespace Lumen {
+	// Picks a level of a LOD chain per object from how large the level's geometric error
+	// appears on screen: the coarsest level whose error projects below `pixelError` wins.
+	// Hysteresis keeps objects near a switching distance from popping back and forth,
+	// a level is only left once its projected error moves `hysteresis` (a fraction) past the threshold.
+	class LODSelector {
+	public:
+		struct Stats {
+			uint objects = 0;
+			uint switches = 0;
+			uint levels[8] = {};	// objects per level, the last entry also counts deeper levels
+		};
+
+		LODSelector(float pixelError = 1.0f, float hysteresis = 0.25f);
+
+		// Once per frame, before Select()
+		void Begin(const Camera& camera, float viewportHeight);
+
+		// Size in pixels of something `size` units across at `center`
+		float GetProjectedSize(const cx::Vec3& center, float size) const;
+
+		// `level` is the object's current level and is updated in place. `errors` holds the
+		// chain's errors in increasing order, `radius` bounds the object around `center`
+		uint Select(const cx::Vec3& center, float radius, const float *errors, uint levelCount, uint& level);
+		uint Select(const cx::Vec3& center, float radius, const std::vector<MeshLOD>& chain, uint& level);
+
+		const Stats& GetStats() const { return m_stats; }
+	private:
+		float m_pixelError;
+		float m_hysteresis;
+		cx::Vec3 m_position;
+		float m_pixelsPerUnit = 1.0f;	// at distance 1 for perspective, everywhere for orthographic
+		bool m_perspective = true;
+		Stats m_stats;
+		std::vector<float> m_errors;
+	};
+}
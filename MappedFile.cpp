@@ -0,0 +1,109 @@
+#include "MappedFile.h"
+
+#include <iostream>
+
+#ifdef _WIN32
+#	ifndef WIN32_LEAN_AND_MEAN
+#		define WIN32_LEAN_AND_MEAN
+#	endif
+#	ifndef NOMINMAX
+#		define NOMINMAX
+#	endif
+#	include <windows.h>
+#else
+#	include <fcntl.h>
+#	include <unistd.h>
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#endif
+
+namespace Lumen {
+	MappedFile::~MappedFile()
+	{
+		Close();
+	}
+
+#ifdef _WIN32
+	bool MappedFile::Open(const std::string& path)
+	{
+		Close();
+
+		HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE) {
+			std::cerr << "Failed to open file: " << path << std::endl;
+			return false;
+		}
+
+		LARGE_INTEGER size;
+		HANDLE mapping = nullptr;
+		if (GetFileSizeEx(file, &size) && size.QuadPart > 0) {
+			mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		}
+		const void *data = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+		if (!data) {
+			std::cerr << "Failed to map file: " << path << std::endl;
+			if (mapping) {
+				CloseHandle(mapping);
+			}
+			CloseHandle(file);
+			return false;
+		}
+
+		m_file = file;
+		m_mapping = mapping;
+		m_data = (const unsigned char *)data;
+		m_size = (size_t)size.QuadPart;
+		return true;
+	}
+
+	void MappedFile::Close()
+	{
+		if (m_data) {
+			UnmapViewOfFile(m_data);
+			CloseHandle(m_mapping);
+			CloseHandle(m_file);
+		}
+		m_data = nullptr;
+		m_size = 0;
+		m_file = nullptr;
+		m_mapping = nullptr;
+	}
+#else
+	bool MappedFile::Open(const std::string& path)
+	{
+		Close();
+
+		const int fd = open(path.c_str(), O_RDONLY);
+		if (fd < 0) {
+			std::cerr << "Failed to open file: " << path << std::endl;
+			return false;
+		}
+
+		struct stat info;
+		void *data = MAP_FAILED;
+		if (fstat(fd, &info) == 0 && info.st_size > 0) {
+			data = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		}
+		// the mapping keeps the file alive on its own
+		close(fd);
+
+		if (data == MAP_FAILED) {
+			std::cerr << "Failed to map file: " << path << std::endl;
+			return false;
+		}
+
+		m_data = (const unsigned char *)data;
+		m_size = (size_t)info.st_size;
+		return true;
+	}
+
+	void MappedFile::Close()
+	{
+		if (m_data) {
+			munmap((void *)m_data, m_size);
+		}
+		m_data = nullptr;
+		m_size = 0;
+	}
+#endif
+}
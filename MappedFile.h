@@ -0,0 +1,32 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+#include "types.h"
+
+namespace Lumen {
+	// Read-only memory mapping of a whole file. Pages are faulted in on first touch, so
+	// opening is cheap regardless of the file size
+	class MappedFile {
+	public:
+		MappedFile() = default;
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		bool Open(const std::string& path);
+		void Close();
+
+		bool IsOpen() const { return m_data != nullptr; }
+		const unsigned char *GetData() const { return m_data; }
+		size_t GetSize() const { return m_size; }
+	private:
+		const unsigned char *m_data = nullptr;
+		size_t m_size = 0;
+#ifdef _WIN32
+		void *m_file = nullptr;
+		void *m_mapping = nullptr;
+#endif
+	};
+}
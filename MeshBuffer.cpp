@@ -0,0 +1,65 @@
+#include "MeshBuffer.h"
+
+namespace Lumen {
+	MeshBuffer::MeshBuffer(const VertexBufferLayout& layout, uint maxVertices, uint maxIndices, uint maxInstances)
+		: m_stride(layout.GetStride()), m_maxVertices(maxVertices), m_maxIndices(maxIndices), m_maxInstances(maxInstances)
+	{
+		m_vertexArray = std::make_shared<VertexArray>();
+		m_vertices = std::make_shared<VertexBuffer>(nullptr, maxVertices * m_stride);
+		m_indices = std::make_shared<IndexBuffer>(nullptr, maxIndices * (uint)sizeof(uint));
+
+		m_vertexArray->AddBuffer(m_vertices, layout);
+		m_vertexArray->AddVertexBuffer(m_vertices);
+		m_vertexArray->AddIndexBuffer(m_indices);
+
+		// the draw index comes after every location the layout used
+		for (const VertexBufferLayoutElement& element : layout.GetElements()) {
+			m_drawIndexLocation += (element.count + 3) / 4;
+		}
+
+		// floats are exact up to 2^24, more than enough instances
+		std::vector<float> drawIndices(maxInstances);
+		for (uint i = 0; i < maxInstances; i++) {
+			drawIndices[i] = (float)i;
+		}
+		m_drawIndices = std::make_shared<VertexBuffer>(drawIndices.data(), maxInstances * (uint)sizeof(float));
+
+		VertexBufferLayout drawIndexLayout(1);
+		drawIndexLayout.Push<float>(1);
+		m_vertexArray->AddBuffer(m_drawIndices, drawIndexLayout);
+		m_vertexArray->AddVertexBuffer(m_drawIndices);
+	}
+
+	bool MeshBuffer::Add(const void *vertices, uint vertexCount, const uint *indices, uint indexCount, MeshRange& range)
+	{
+		if (m_vertexCount + vertexCount > m_maxVertices || m_indexCount + indexCount > m_maxIndices) {
+			std::cerr << "MeshBuffer: no room for " << vertexCount << " vertices / " << indexCount << " indices" << std::endl;
+			return false;
+		}
+
+		range.firstIndex = m_indexCount;
+		range.indexCount = indexCount;
+		range.baseVertex = (int)m_vertexCount;
+		range.vertexCount = vertexCount;
+
+		m_vertices->SetSubData(vertices, vertexCount * m_stride, m_vertexCount * m_stride);
+		m_indices->SetSubData(indices, indexCount * (uint)sizeof(uint), m_indexCount * (uint)sizeof(uint));
+
+		m_vertexCount += vertexCount;
+		m_indexCount += indexCount;
+		return true;
+	}
+
+	void MeshBuffer::Clear()
+	{
+		m_vertexCount = 0;
+		m_indexCount = 0;
+	}
+
+	void MeshBuffer::SetDrawIndexBase(uint first)
+	{
+		m_vertexArray->Bind();
+		m_drawIndices->Bind();
+		GLCall(glVertexAttribPointer(m_drawIndexLocation, 1, GL_FLOAT, GL_FALSE, sizeof(float), (const void*)(size_t)(first * sizeof(float))));
+	}
+}
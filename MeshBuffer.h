@@ -0,0 +1,65 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <glad/glad.h>
+#include "types.h"
+#include "VertexArray.h"
+#include "VertexBuffer.h"
+#include "IndexBuffer.h"
+#include "VertexBufferLayout.h"
+
+namespace Lumen {
+	// Where a mesh lives inside a MeshBuffer, in the terms of DrawElementsIndirectCommand
+	struct MeshRange {
+		uint firstIndex = 0;
+		uint indexCount = 0;
+		int baseVertex = 0;
+		uint vertexCount = 0;
+	};
+
+	// Megabuffer: one vertex buffer, one 32-bit index buffer and one vertex array shared by
+	// many meshes of the same layout, so they can all go out in a single multi-draw.
+	// Each mesh keeps its own 0 based indices, draws add its baseVertex.
+	// After the layout's attributes comes one per-instance float attribute holding the draw
+	// index (see IndirectDrawList), read it in GLSL as
+	// `layout(location = GetDrawIndexLocation()) in float a_DrawIndex;`
+	class MeshBuffer {
+	public:
+		MeshBuffer(const VertexBufferLayout& layout, uint maxVertices, uint maxIndices, uint maxInstances = 16384);
+
+		MeshBuffer(const MeshBuffer&) = delete;
+		MeshBuffer& operator=(const MeshBuffer&) = delete;
+
+		// `vertices` must match the layout's stride. Returns false when the buffer is full
+		bool Add(const void *vertices, uint vertexCount, const uint *indices, uint indexCount, MeshRange& range);
+		// Forgets every mesh, the next Add() starts writing at the beginning again
+		void Clear();
+
+		void Bind() const { m_vertexArray->Bind(); }
+		const std::shared_ptr<VertexArray>& GetVertexArray() const { return m_vertexArray; }
+		uint GetDrawIndexLocation() const { return m_drawIndexLocation; }
+		uint GetMaxInstances() const { return m_maxInstances; }
+		uint GetStride() const { return m_stride; }
+
+		uint GetVertexCount() const { return m_vertexCount; }
+		uint GetIndexCount() const { return m_indexCount; }
+		uint GetMaxVertices() const { return m_maxVertices; }
+		uint GetMaxIndices() const { return m_maxIndices; }
+
+		// Points the draw index attribute at `first`, for drivers without base instance
+		void SetDrawIndexBase(uint first);
+	private:
+		std::shared_ptr<VertexArray> m_vertexArray;
+		std::shared_ptr<VertexBuffer> m_vertices;
+		std::shared_ptr<IndexBuffer> m_indices;
+		std::shared_ptr<VertexBuffer> m_drawIndices;
+		uint m_stride;
+		uint m_maxVertices;
+		uint m_maxIndices;
+		uint m_maxInstances;
+		uint m_vertexCount = 0;
+		uint m_indexCount = 0;
+		uint m_drawIndexLocation = 0;
+	};
+}
@@ -0,0 +1,332 @@
+#include "MeshOptimizer.h"
+
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <algorithm>
+
+namespace Lumen {
+	// FIFO post-transform cache, what most GPUs approximate
+	class VertexCache {
+	public:
+		VertexCache(uint vertexCount, uint size)
+			: m_stamps(vertexCount, 0), m_size(size), m_time(size + 1)
+		{
+		}
+
+		// Returns true on a miss
+		bool Access(uint vertex)
+		{
+			if (m_time - m_stamps[vertex] <= m_size) {
+				return false;
+			}
+			m_stamps[vertex] = m_time++;
+			return true;
+		}
+
+		void Flush() { m_time += m_size + 1; }
+	private:
+		std::vector<uint> m_stamps;
+		uint m_size;
+		uint m_time;
+	};
+
+	static uint CountTransforms(const uint *indices, uint indexCount, uint vertexCount, uint cacheSize)
+	{
+		VertexCache cache(vertexCount, cacheSize);
+		uint misses = 0;
+		for (uint i = 0; i < indexCount; i++) {
+			misses += cache.Access(indices[i]);
+		}
+		return misses;
+	}
+
+	float MeshOptimizer::GetACMR(const uint *indices, uint indexCount, uint vertexCount, uint cacheSize)
+	{
+		return indexCount < 3 ? 0.0f : (float)CountTransforms(indices, indexCount, vertexCount, cacheSize) / (indexCount / 3);
+	}
+
+	float MeshOptimizer::GetATVR(const uint *indices, uint indexCount, uint vertexCount, uint cacheSize)
+	{
+		std::vector<bool> used(vertexCount, false);
+		uint usedCount = 0;
+		for (uint i = 0; i < indexCount; i++) {
+			if (!used[indices[i]]) {
+				used[indices[i]] = true;
+				usedCount++;
+			}
+		}
+		return usedCount ? (float)CountTransforms(indices, indexCount, vertexCount, cacheSize) / usedCount : 0.0f;
+	}
+
+	void MeshOptimizer::OptimizeVertexCache(uint *indices, uint indexCount, uint vertexCount, std::vector<uint> *clusters, uint cacheSize)
+	{
+		const uint triangleCount = indexCount / 3;
+		if (clusters) {
+			clusters->clear();
+		}
+		if (triangleCount == 0) {
+			return;
+		}
+
+		// vertex -> triangles, as offsets into one array
+		std::vector<uint> live(vertexCount, 0);
+		for (uint i = 0; i < triangleCount * 3; i++) {
+			live[indices[i]]++;
+		}
+		std::vector<uint> offsets(vertexCount + 1, 0);
+		for (uint v = 0; v < vertexCount; v++) {
+			offsets[v + 1] = offsets[v] + live[v];
+		}
+		std::vector<uint> adjacency(triangleCount * 3);
+		{
+			std::vector<uint> fill(offsets.begin(), offsets.end() - 1);
+			for (uint t = 0; t < triangleCount; t++) {
+				for (uint k = 0; k < 3; k++) {
+					adjacency[fill[indices[t * 3 + k]]++] = t;
+				}
+			}
+		}
+
+		std::vector<uint> stamps(vertexCount, 0);
+		std::vector<bool> emitted(triangleCount, false);
+		std::vector<uint> deadEnds;
+		std::vector<uint> candidates;
+		std::vector<uint> output;
+		output.reserve(triangleCount * 3);
+
+		uint time = cacheSize + 1;
+		uint cursor = 0;
+		int fanning = indices[0];
+		bool restarted = true;
+
+		while (fanning >= 0) {
+			if (restarted && clusters) {
+				clusters->push_back((uint)output.size() / 3);
+			}
+
+			// emit every remaining triangle around the fanning vertex
+			candidates.clear();
+			for (uint a = offsets[fanning]; a < offsets[fanning + 1]; a++) {
+				const uint t = adjacency[a];
+				if (emitted[t]) {
+					continue;
+				}
+				for (uint k = 0; k < 3; k++) {
+					const uint v = indices[t * 3 + k];
+					output.push_back(v);
+					deadEnds.push_back(v);
+					candidates.push_back(v);
+					live[v]--;
+					if (time - stamps[v] > cacheSize) {
+						stamps[v] = time++;
+					}
+				}
+				emitted[t] = true;
+			}
+
+			// next fan: the candidate that will still be in the cache after its own triangles
+			// went through, preferring the oldest such entry
+			int best = -1;
+			int bestPriority = -1;
+			for (uint v : candidates) {
+				if (live[v] == 0) {
+					continue;
+				}
+				int priority = 0;
+				if (time - stamps[v] + 2 * live[v] <= cacheSize) {
+					priority = (int)(time - stamps[v]);
+				}
+				if (priority > bestPriority) {
+					best = (int)v;
+					bestPriority = priority;
+				}
+			}
+
+			restarted = false;
+			if (best < 0) {
+				while (!deadEnds.empty() && best < 0) {
+					const uint v = deadEnds.back();
+					deadEnds.pop_back();
+					if (live[v] > 0) {
+						best = (int)v;
+					}
+				}
+				while (best < 0 && cursor < vertexCount) {
+					if (live[cursor] > 0) {
+						best = (int)cursor;
+						restarted = true;
+					}
+					cursor++;
+				}
+			}
+			fanning = best;
+		}
+
+		std::memcpy(indices, output.data(), output.size() * sizeof(uint));
+	}
+
+	void MeshOptimizer::OptimizeOverdraw(uint *indices, uint indexCount, const void *vertices, uint vertexCount, uint stride,
+		const std::vector<uint>& clusters, float threshold)
+	{
+		const uint triangleCount = indexCount / 3;
+		if (triangleCount == 0) {
+			return;
+		}
+		auto position = [&](uint v) {
+			return (const float *)((const unsigned char *)vertices + (size_t)v * stride);
+		};
+
+		// split the cache clusters further wherever the piece so far is already about as cache
+		// efficient as the whole mesh, so the reorder below costs at most `threshold` in ACMR
+		const float target = GetACMR(indices, indexCount, vertexCount) * threshold;
+		std::vector<uint> starts;
+		{
+			VertexCache cache(vertexCount, CacheSize);
+			std::vector<uint> hard(clusters);
+			if (hard.empty() || hard[0] != 0) {
+				hard.insert(hard.begin(), 0);
+			}
+			hard.push_back(triangleCount);
+
+			for (size_t c = 0; c + 1 < hard.size(); c++) {
+				uint start = hard[c];
+				uint misses = 0;
+				starts.push_back(start);
+				cache.Flush();
+				for (uint t = hard[c]; t < hard[c + 1]; t++) {
+					for (uint k = 0; k < 3; k++) {
+						misses += cache.Access(indices[t * 3 + k]);
+					}
+					const uint length = t - start + 1;
+					if (t + 1 < hard[c + 1] && length >= 8 && (float)misses / length <= target) {
+						start = t + 1;
+						misses = 0;
+						starts.push_back(start);
+						cache.Flush();
+					}
+				}
+			}
+		}
+		starts.push_back(triangleCount);
+
+		// mesh centroid and each cluster's area weighted centroid and normal
+		double center[3] = { 0, 0, 0 };
+		double totalArea = 0;
+		const uint clusterCount = (uint)starts.size() - 1;
+		std::vector<double> clusterData(clusterCount * 6, 0.0);
+		for (uint c = 0; c < clusterCount; c++) {
+			double *data = &clusterData[c * 6];
+			double area = 0;
+			for (uint t = starts[c]; t < starts[c + 1]; t++) {
+				const float *p0 = position(indices[t * 3]), *p1 = position(indices[t * 3 + 1]), *p2 = position(indices[t * 3 + 2]);
+				const double e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+				const double e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+				const double n[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+				const double a = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+				for (uint k = 0; k < 3; k++) {
+					const double centroid = (p0[k] + p1[k] + p2[k]) / 3.0;
+					data[k] += centroid * a;
+					data[3 + k] += n[k];
+					center[k] += centroid * a;
+				}
+				area += a;
+			}
+			totalArea += area;
+			if (area > 0) {
+				data[0] /= area; data[1] /= area; data[2] /= area;
+			}
+		}
+		if (totalArea > 0) {
+			center[0] /= totalArea; center[1] /= totalArea; center[2] /= totalArea;
+		}
+
+		std::vector<float> scores(clusterCount);
+		for (uint c = 0; c < clusterCount; c++) {
+			const double *data = &clusterData[c * 6];
+			const double length = std::sqrt(data[3] * data[3] + data[4] * data[4] + data[5] * data[5]);
+			scores[c] = length > 0 ? (float)(((data[0] - center[0]) * data[3] + (data[1] - center[1]) * data[4] + (data[2] - center[2]) * data[5]) / length) : 0.0f;
+		}
+
+		std::vector<uint> order(clusterCount);
+		std::iota(order.begin(), order.end(), 0);
+		std::stable_sort(order.begin(), order.end(), [&](uint a, uint b) { return scores[a] > scores[b]; });
+
+		std::vector<uint> sorted;
+		sorted.reserve(triangleCount * 3);
+		for (uint c : order) {
+			sorted.insert(sorted.end(), indices + starts[c] * 3, indices + starts[c + 1] * 3);
+		}
+
+		// the split heuristic is local, check the result before keeping it
+		if (GetACMR(sorted.data(), (uint)sorted.size(), vertexCount) <= target) {
+			std::memcpy(indices, sorted.data(), sorted.size() * sizeof(uint));
+		}
+	}
+
+	uint MeshOptimizer::OptimizeVertexFetch(void *vertices, uint vertexCount, uint stride, uint *indices, uint indexCount)
+	{
+		std::vector<uint> remap(vertexCount, ~0u);
+		uint next = 0;
+		for (uint i = 0; i < indexCount; i++) {
+			uint& target = remap[indices[i]];
+			if (target == ~0u) {
+				target = next++;
+			}
+			indices[i] = target;
+		}
+
+		unsigned char *bytes = (unsigned char *)vertices;
+		std::vector<unsigned char> copy(bytes, bytes + (size_t)vertexCount * stride);
+		for (uint v = 0; v < vertexCount; v++) {
+			if (remap[v] != ~0u) {
+				std::memcpy(bytes + (size_t)remap[v] * stride, copy.data() + (size_t)v * stride, stride);
+			}
+		}
+		return next;
+	}
+
+	IndexData MeshOptimizer::CompressIndices(const uint *indices, uint indexCount, uint vertexCount)
+	{
+		IndexData data;
+		data.count = indexCount;
+		// 0xFFFF stays unused so primitive restart remains possible
+		if (vertexCount <= 0xFFFF) {
+			data.type = GL_UNSIGNED_SHORT;
+			data.bytes.resize(indexCount * sizeof(ushort));
+			ushort *narrow = (ushort *)data.bytes.data();
+			for (uint i = 0; i < indexCount; i++) {
+				narrow[i] = (ushort)indices[i];
+			}
+		}
+		else {
+			data.type = GL_UNSIGNED_INT;
+			data.bytes.resize(indexCount * sizeof(uint));
+			std::memcpy(data.bytes.data(), indices, data.bytes.size());
+		}
+		return data;
+	}
+
+	MeshOptimizer::Report MeshOptimizer::Optimize(void *vertices, uint& vertexCount, uint stride, std::vector<uint>& indices,
+		IndexData& compressed, float overdrawThreshold)
+	{
+		Report report;
+		const uint indexCount = (uint)indices.size();
+		report.acmrBefore = GetACMR(indices.data(), indexCount, vertexCount);
+		report.atvrBefore = GetATVR(indices.data(), indexCount, vertexCount);
+		report.vertexCountBefore = vertexCount;
+		report.indexBytesBefore = indexCount * (uint)sizeof(uint);
+
+		std::vector<uint> clusters;
+		OptimizeVertexCache(indices.data(), indexCount, vertexCount, &clusters);
+		OptimizeOverdraw(indices.data(), indexCount, vertices, vertexCount, stride, clusters, overdrawThreshold);
+		vertexCount = OptimizeVertexFetch(vertices, vertexCount, stride, indices.data(), indexCount);
+		compressed = CompressIndices(indices.data(), indexCount, vertexCount);
+
+		report.acmrAfter = GetACMR(indices.data(), indexCount, vertexCount);
+		report.atvrAfter = GetATVR(indices.data(), indexCount, vertexCount);
+		report.vertexCountAfter = vertexCount;
+		report.indexBytesAfter = compressed.GetSize();
+		return report;
+	}
+}
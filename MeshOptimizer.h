@@ -0,0 +1,57 @@
+#pragma once
+
+#include <vector>
+#include <glad/glad.h>
+#include "types.h"
+
+namespace Lumen {
+	// Index data in the narrowest type that can address every vertex
+	struct IndexData {
+		GLenum type = GL_UNSIGNED_INT;
+		uint count = 0;
+		std::vector<unsigned char> bytes;
+
+		const void *GetData() const { return bytes.data(); }
+		uint GetSize() const { return (uint)bytes.size(); }
+	};
+
+	// Import time reordering of triangle lists for the GPU:
+	//  - OptimizeVertexCache: Tipsify (Sander et al. 2007), keeps recently used vertices in the
+	//    post-transform cache and splits the mesh into clusters at every cache restart
+	//  - OptimizeOverdraw: refines those clusters while the cache cost stays within `threshold`,
+	//    then draws the most outward facing ones first so they occlude the rest
+	//  - OptimizeVertexFetch: renumbers vertices in first use order and drops unused ones
+	//  - CompressIndices: 16 bit indices whenever the vertex count allows
+	// Positions are read as three floats at the start of every vertex.
+	class MeshOptimizer {
+	public:
+		static const uint CacheSize = 16;
+
+		struct Report {
+			float acmrBefore = 0.0f;	// vertex transforms per triangle with a CacheSize FIFO, 0.5 - 3
+			float acmrAfter = 0.0f;
+			float atvrBefore = 0.0f;	// transforms per vertex, 1 is ideal
+			float atvrAfter = 0.0f;
+			uint vertexCountBefore = 0;
+			uint vertexCountAfter = 0;
+			uint indexBytesBefore = 0;
+			uint indexBytesAfter = 0;
+		};
+
+		static float GetACMR(const uint *indices, uint indexCount, uint vertexCount, uint cacheSize = CacheSize);
+		static float GetATVR(const uint *indices, uint indexCount, uint vertexCount, uint cacheSize = CacheSize);
+
+		// `clusters` receives the first triangle of every cluster
+		static void OptimizeVertexCache(uint *indices, uint indexCount, uint vertexCount, std::vector<uint> *clusters = nullptr,
+			uint cacheSize = CacheSize);
+		static void OptimizeOverdraw(uint *indices, uint indexCount, const void *vertices, uint vertexCount, uint stride,
+			const std::vector<uint>& clusters, float threshold = 1.05f);
+		// Returns the new vertex count, `vertices` is compacted in place
+		static uint OptimizeVertexFetch(void *vertices, uint vertexCount, uint stride, uint *indices, uint indexCount);
+		static IndexData CompressIndices(const uint *indices, uint indexCount, uint vertexCount);
+
+		// All of the above in order. `vertexCount` is updated, `indices` keeps the 32 bit copy
+		static Report Optimize(void *vertices, uint& vertexCount, uint stride, std::vector<uint>& indices, IndexData& compressed,
+			float overdrawThreshold = 1.05f);
+	};
+}
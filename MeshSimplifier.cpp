@@ -0,0 +1,314 @@
+#include "MeshSimplifier.h"
+
+#include <cmath>
+#include <cstring>
+#include <queue>
+#include <algorithm>
+#include <unordered_map>
+
+namespace Lumen {
+	// keeps open borders from being pulled inwards, relative to the surface quadrics
+	static const double BorderWeight = 10.0;
+
+	// Sum of squared plane distances as a symmetric 4x4 matrix, plus the total weight so the
+	// error can be reported as a mean squared distance
+	struct Quadric {
+		double a00 = 0, a01 = 0, a02 = 0, a11 = 0, a12 = 0, a22 = 0;
+		double b0 = 0, b1 = 0, b2 = 0, c = 0;
+		double weight = 0;
+
+		void AddPlane(double nx, double ny, double nz, double d, double w)
+		{
+			a00 += w * nx * nx; a01 += w * nx * ny; a02 += w * nx * nz;
+			a11 += w * ny * ny; a12 += w * ny * nz; a22 += w * nz * nz;
+			b0 += w * nx * d; b1 += w * ny * d; b2 += w * nz * d;
+			c += w * d * d;
+			weight += w;
+		}
+
+		Quadric& operator+=(const Quadric& other)
+		{
+			a00 += other.a00; a01 += other.a01; a02 += other.a02;
+			a11 += other.a11; a12 += other.a12; a22 += other.a22;
+			b0 += other.b0; b1 += other.b1; b2 += other.b2;
+			c += other.c;
+			weight += other.weight;
+			return *this;
+		}
+
+		// mean squared distance of p to the accumulated planes
+		double GetError(const float *p) const
+		{
+			const double x = p[0], y = p[1], z = p[2];
+			const double sum = a00 * x * x + a11 * y * y + a22 * z * z +
+				2.0 * (a01 * x * y + a02 * x * z + a12 * y * z) +
+				2.0 * (b0 * x + b1 * y + b2 * z) + c;
+			return weight > 0.0 ? std::max(sum, 0.0) / weight : 0.0;
+		}
+	};
+
+	struct Collapse {
+		double error;
+		uint from, to;
+		uint fromVersion, toVersion;
+
+		bool operator>(const Collapse& other) const { return error > other.error; }
+	};
+
+	struct PositionKey {
+		float x, y, z;
+
+		bool operator==(const PositionKey& other) const { return x == other.x && y == other.y && z == other.z; }
+	};
+
+	struct PositionHash {
+		size_t operator()(const PositionKey& key) const
+		{
+			uint bits[3];
+			std::memcpy(bits, &key, sizeof(bits));
+			return (size_t)bits[0] * 73856093u ^ (size_t)bits[1] * 19349663u ^ (size_t)bits[2] * 83492791u;
+		}
+	};
+
+	static void GetNormal(const float *p0, const float *p1, const float *p2, double n[3])
+	{
+		const double e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+		const double e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+		n[0] = e1[1] * e2[2] - e1[2] * e2[1];
+		n[1] = e1[2] * e2[0] - e1[0] * e2[2];
+		n[2] = e1[0] * e2[1] - e1[1] * e2[0];
+	}
+
+	std::vector<uint> MeshSimplifier::Simplify(const float *positions, uint vertexCount, uint stride,
+		const uint *indices, uint indexCount, uint targetIndexCount, float maxError, float *resultError)
+	{
+		std::vector<uint> triangles(indices, indices + indexCount - indexCount % 3);
+		if (resultError) {
+			*resultError = 0.0f;
+		}
+		if (targetIndexCount >= triangles.size()) {
+			return triangles;
+		}
+
+		auto position = [&](uint v) {
+			return (const float *)((const unsigned char *)positions + (size_t)v * stride);
+		};
+
+		const uint triangleCount = (uint)triangles.size() / 3;
+		std::vector<std::vector<uint>> vertexTriangles(vertexCount);
+		for (uint t = 0; t < triangleCount; t++) {
+			for (uint k = 0; k < 3; k++) {
+				vertexTriangles[triangles[t * 3 + k]].push_back(t);
+			}
+		}
+
+		// seams: several vertices on one position, moving one would tear the surface open
+		std::vector<bool> locked(vertexCount, false);
+		{
+			std::unordered_map<PositionKey, uint, PositionHash> first;
+			for (uint v = 0; v < vertexCount; v++) {
+				if (vertexTriangles[v].empty()) {
+					continue;
+				}
+				const float *p = position(v);
+				auto inserted = first.emplace(PositionKey { p[0], p[1], p[2] }, v);
+				if (!inserted.second) {
+					locked[v] = true;
+					locked[inserted.first->second] = true;
+				}
+			}
+		}
+
+		std::vector<bool> alive(triangleCount, true);
+		auto countShared = [&](uint v, uint u) {
+			uint count = 0;
+			for (uint t : vertexTriangles[v]) {
+				if (alive[t] && (triangles[t * 3] == u || triangles[t * 3 + 1] == u || triangles[t * 3 + 2] == u)) {
+					count++;
+				}
+			}
+			return count;
+		};
+
+		std::vector<Quadric> quadrics(vertexCount);
+		std::vector<bool> border(vertexCount, false);
+		for (uint t = 0; t < triangleCount; t++) {
+			const uint *tri = &triangles[t * 3];
+			double n[3];
+			GetNormal(position(tri[0]), position(tri[1]), position(tri[2]), n);
+			const double length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+			if (length <= 0.0) {
+				continue;
+			}
+			n[0] /= length; n[1] /= length; n[2] /= length;
+
+			const float *p0 = position(tri[0]);
+			const double d = -(n[0] * p0[0] + n[1] * p0[1] + n[2] * p0[2]);
+			for (uint k = 0; k < 3; k++) {
+				quadrics[tri[k]].AddPlane(n[0], n[1], n[2], d, length * 0.5);
+			}
+
+			// border edges get a plane through the edge, perpendicular to the triangle
+			for (uint k = 0; k < 3; k++) {
+				const uint a = tri[k], b = tri[(k + 1) % 3];
+				if (countShared(a, b) != 1) {
+					continue;
+				}
+				border[a] = border[b] = true;
+
+				const float *pa = position(a), *pb = position(b);
+				const double e[3] = { pb[0] - pa[0], pb[1] - pa[1], pb[2] - pa[2] };
+				double m[3] = { e[1] * n[2] - e[2] * n[1], e[2] * n[0] - e[0] * n[2], e[0] * n[1] - e[1] * n[0] };
+				const double edgeLength = std::sqrt(m[0] * m[0] + m[1] * m[1] + m[2] * m[2]);
+				if (edgeLength <= 0.0) {
+					continue;
+				}
+				m[0] /= edgeLength; m[1] /= edgeLength; m[2] /= edgeLength;
+				const double md = -(m[0] * pa[0] + m[1] * pa[1] + m[2] * pa[2]);
+				const double w = (e[0] * e[0] + e[1] * e[1] + e[2] * e[2]) * BorderWeight;
+				quadrics[a].AddPlane(m[0], m[1], m[2], md, w);
+				quadrics[b].AddPlane(m[0], m[1], m[2], md, w);
+			}
+		}
+
+		std::vector<uint> versions(vertexCount, 0);
+		std::vector<bool> removed(vertexCount, false);
+		std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> heap;
+
+		auto consider = [&](uint from, uint to) {
+			if (locked[from]) {
+				return;
+			}
+			// border vertices may only slide along their own border
+			if (border[from] && (!border[to] || countShared(from, to) != 1)) {
+				return;
+			}
+			Quadric combined = quadrics[from];
+			combined += quadrics[to];
+			heap.push({ combined.GetError(position(to)), from, to, versions[from], versions[to] });
+		};
+
+		for (uint t = 0; t < triangleCount; t++) {
+			for (uint k = 0; k < 3; k++) {
+				const uint a = triangles[t * 3 + k], b = triangles[t * 3 + (k + 1) % 3];
+				consider(a, b);
+				consider(b, a);
+			}
+		}
+
+		const double maxSquaredError = (double)maxError * maxError;
+		uint liveTriangles = triangleCount;
+		double worstError = 0.0;
+		std::vector<uint> neighbours;
+
+		while (liveTriangles * 3 > targetIndexCount && !heap.empty()) {
+			const Collapse collapse = heap.top();
+			heap.pop();
+			if (removed[collapse.from] || removed[collapse.to] ||
+				versions[collapse.from] != collapse.fromVersion || versions[collapse.to] != collapse.toVersion) {
+				continue;
+			}
+			if (collapse.error > maxSquaredError) {
+				break;
+			}
+
+			// reject collapses that flip or flatten a surviving triangle
+			const float *target = position(collapse.to);
+			bool flips = false;
+			for (uint t : vertexTriangles[collapse.from]) {
+				const uint *tri = &triangles[t * 3];
+				if (!alive[t] || tri[0] == collapse.to || tri[1] == collapse.to || tri[2] == collapse.to) {
+					continue;
+				}
+				const float *p[3], *moved[3];
+				for (uint k = 0; k < 3; k++) {
+					p[k] = position(tri[k]);
+					moved[k] = tri[k] == collapse.from ? target : p[k];
+				}
+				double before[3], after[3];
+				GetNormal(p[0], p[1], p[2], before);
+				GetNormal(moved[0], moved[1], moved[2], after);
+				if (before[0] * after[0] + before[1] * after[1] + before[2] * after[2] <= 0.0) {
+					flips = true;
+					break;
+				}
+			}
+			if (flips) {
+				continue;
+			}
+
+			removed[collapse.from] = true;
+			quadrics[collapse.to] += quadrics[collapse.from];
+			versions[collapse.to]++;
+			worstError = std::max(worstError, collapse.error);
+
+			for (uint t : vertexTriangles[collapse.from]) {
+				if (!alive[t]) {
+					continue;
+				}
+				uint *tri = &triangles[t * 3];
+				if (tri[0] == collapse.to || tri[1] == collapse.to || tri[2] == collapse.to) {
+					alive[t] = false;
+					liveTriangles--;
+					continue;
+				}
+				for (uint k = 0; k < 3; k++) {
+					if (tri[k] == collapse.from) {
+						tri[k] = collapse.to;
+					}
+				}
+				vertexTriangles[collapse.to].push_back(t);
+			}
+
+			neighbours.clear();
+			for (uint t : vertexTriangles[collapse.to]) {
+				if (alive[t]) {
+					neighbours.insert(neighbours.end(), &triangles[t * 3], &triangles[t * 3] + 3);
+				}
+			}
+			std::sort(neighbours.begin(), neighbours.end());
+			neighbours.erase(std::unique(neighbours.begin(), neighbours.end()), neighbours.end());
+			for (uint w : neighbours) {
+				if (w != collapse.to) {
+					consider(collapse.to, w);
+					consider(w, collapse.to);
+				}
+			}
+		}
+
+		std::vector<uint> result;
+		result.reserve(liveTriangles * 3);
+		for (uint t = 0; t < triangleCount; t++) {
+			if (alive[t]) {
+				result.insert(result.end(), &triangles[t * 3], &triangles[t * 3] + 3);
+			}
+		}
+		if (resultError) {
+			*resultError = (float)std::sqrt(worstError);
+		}
+		return result;
+	}
+
+	std::vector<MeshLOD> MeshSimplifier::BuildChain(const float *positions, uint vertexCount, uint stride,
+		const uint *indices, uint indexCount, uint levelCount, float ratio)
+	{
+		std::vector<MeshLOD> chain(1);
+		chain[0].indices.assign(indices, indices + indexCount);
+
+		for (uint level = 1; level < levelCount; level++) {
+			const MeshLOD& previous = chain.back();
+			const uint target = (uint)(previous.indices.size() / 3 * ratio) * 3;
+
+			// each level starts from the previous one, so errors add up along the chain
+			MeshLOD lod;
+			float error = 0.0f;
+			lod.indices = Simplify(positions, vertexCount, stride, previous.indices.data(), (uint)previous.indices.size(), target, 1e30f, &error);
+			if (lod.indices.size() * 20 > previous.indices.size() * 19) {
+				break;
+			}
+			lod.error = previous.error + error;
+			chain.push_back(std::move(lod));
+		}
+		return chain;
+	}
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <vector>
+#include "types.h"
+
+namespace Lumen {
+	// One level of a LOD chain. Levels index the same vertices as the source mesh, so a whole
+	// chain shares one VertexBuffer (or MeshBuffer range) and only the index data differs
+	struct MeshLOD {
+		std::vector<uint> indices;
+		float error = 0.0f;		// worst geometric deviation from the source, in mesh units
+	};
+
+	// Quadric error metric simplification (Garland & Heckbert) by edge collapse onto existing
+	// vertices. Collapses that would flip a triangle are rejected. Vertices where several
+	// indices share one position (UV or normal seams) stay put, and open borders only
+	// shrink along themselves, so meshes keep their outline and texture layout intact.
+	class MeshSimplifier {
+	public:
+		// `positions` points at the first vertex's xyz, `stride` is the vertex size in bytes.
+		// Stops at `targetIndexCount` or once the next collapse would exceed `maxError`
+		static std::vector<uint> Simplify(const float *positions, uint vertexCount, uint stride,
+			const uint *indices, uint indexCount, uint targetIndexCount, float maxError = 1e30f, float *resultError = nullptr);
+
+		// Level 0 is the source, every further level keeps about `ratio` of the previous one's
+		// triangles. The chain ends early when a level no longer shrinks
+		static std::vector<MeshLOD> BuildChain(const float *positions, uint vertexCount, uint stride,
+			const uint *indices, uint indexCount, uint levelCount = 4, float ratio = 0.5f);
+	};
+}
@@ -0,0 +1,322 @@
+#include "Profiler.h"
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+
+namespace Lumen {
+	namespace {
+		const std::chrono::steady_clock::time_point Epoch = std::chrono::steady_clock::now();
+		const uint GPUThread = ~0u;
+
+		void WriteJSONString(std::ostream& out, const char *s)
+		{
+			out << '"';
+			for (; *s; s++) {
+				if (*s == '"' || *s == '\\') {
+					out << '\\' << *s;
+				}
+				else if ((unsigned char)*s >= 0x20) {
+					out << *s;
+				}
+			}
+			out << '"';
+		}
+	}
+
+	std::mutex Profiler::m_mutex;
+	std::vector<std::unique_ptr<Profiler::ThreadRing>> Profiler::m_rings;
+	std::atomic<uint64_t> Profiler::m_dropped { 0 };
+	Profiler::GPUFrame Profiler::m_gpuFrames[GPUFrameLatency];
+	uint Profiler::m_gpuFrame = 0;
+	uint Profiler::m_gpuOpen = 0;
+	bool Profiler::m_gpuTiming = false;
+	Profiler::HistoryTable Profiler::m_cpuHistory;
+	Profiler::HistoryTable Profiler::m_gpuHistory;
+	uint64_t Profiler::m_lastFrame = 0;
+	bool Profiler::m_capturing = false;
+	size_t Profiler::m_captureLimit = 0;
+	std::vector<Profiler::CapturedEvent> Profiler::m_capture;
+
+	uint64_t Profiler::Now()
+	{
+		return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - Epoch).count();
+	}
+
+	Profiler::ThreadRing& Profiler::GetRing()
+	{
+		// rings are never freed, a thread that exits leaves its last events to be drained
+		thread_local ThreadRing *ring = nullptr;
+		if (!ring) {
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_rings.emplace_back(new ThreadRing());
+			ring = m_rings.back().get();
+			ring->id = (uint)m_rings.size() - 1;
+		}
+		return *ring;
+	}
+
+	void Profiler::SetThreadName(const char *name)
+	{
+		ThreadRing& ring = GetRing();
+		std::lock_guard<std::mutex> lock(m_mutex);
+		ring.name = name;
+	}
+
+	uint Profiler::EnterScope()
+	{
+		return GetRing().depth++;
+	}
+
+	void Profiler::LeaveScope(const char *name, uint64_t start, uint depth)
+	{
+		ThreadRing& ring = GetRing();
+		ring.depth = depth;
+
+		const uint32_t head = ring.head.load(std::memory_order_relaxed);
+		if (head - ring.tail.load(std::memory_order_acquire) >= RingCapacity) {
+			m_dropped.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+		ProfileEvent& event = ring.events[head % RingCapacity];
+		event.name = name;
+		event.start = start;
+		event.end = Now();
+		event.depth = depth;
+		ring.head.store(head + 1, std::memory_order_release);
+	}
+
+	void Profiler::BeginGPU(const char *name, uint64_t cpuStart)
+	{
+		if (m_gpuOpen++ > 0) {
+			return;
+		}
+
+		GPUFrame& frame = m_gpuFrames[m_gpuFrame];
+		const uint index = (uint)frame.scopes.size();
+		m_gpuTiming = index < MaxGPUScopes;
+		if (!m_gpuTiming) {
+			m_dropped.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+		if (index == frame.queries.size()) {
+			uint query = 0;
+			glGenQueries(1, &query);
+			frame.queries.push_back(query);
+		}
+
+		const uint query = frame.queries[index];
+		frame.scopes.push_back({ name, cpuStart, query });
+		glBeginQuery(GL_TIME_ELAPSED, query);
+	}
+
+	void Profiler::EndGPU()
+	{
+		if (m_gpuOpen == 0 || --m_gpuOpen > 0) {
+			return;
+		}
+		if (m_gpuTiming) {
+			glEndQuery(GL_TIME_ELAPSED);
+			m_gpuTiming = false;
+		}
+	}
+
+	void Profiler::CollectGPU(GPUFrame& frame)
+	{
+		if (frame.scopes.empty()) {
+			return;
+		}
+
+		// queries complete in order, the last one being ready means they all are
+		GLint available = 0;
+		glGetQueryObjectiv(frame.scopes.back().query, GL_QUERY_RESULT_AVAILABLE, &available);
+		if (available) {
+			for (const GPUScope& scope : frame.scopes) {
+				GLuint64 elapsed = 0;
+				glGetQueryObjectui64v(scope.query, GL_QUERY_RESULT, &elapsed);
+				AddSample(m_gpuHistory, scope.name, elapsed);
+
+				// elapsed queries carry no timestamp, the GPU track starts each pass where
+				// the CPU issued it
+				ProfileEvent event;
+				event.name = scope.name;
+				event.start = scope.cpuStart;
+				event.end = scope.cpuStart + elapsed;
+				Capture(event, GPUThread);
+			}
+		}
+		else {
+			m_dropped.fetch_add(frame.scopes.size(), std::memory_order_relaxed);
+		}
+		frame.scopes.clear();
+	}
+
+	void Profiler::EndFrame()
+	{
+		const uint64_t now = Now();
+		ThreadRing& own = GetRing();
+
+		// a GPU scope left open would leave its query running into the next frame
+		if (m_gpuOpen > 0) {
+			std::cerr << "Profiler: GPU scope still open at the end of the frame" << std::endl;
+			m_gpuOpen = 1;
+			EndGPU();
+		}
+		m_gpuFrame = (m_gpuFrame + 1) % GPUFrameLatency;
+		CollectGPU(m_gpuFrames[m_gpuFrame]);
+
+		std::vector<ThreadRing *> rings;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			for (auto& ring : m_rings) {
+				rings.push_back(ring.get());
+			}
+		}
+		for (ThreadRing *ring : rings) {
+			const uint32_t tail = ring->tail.load(std::memory_order_relaxed);
+			const uint32_t head = ring->head.load(std::memory_order_acquire);
+			for (uint32_t i = tail; i != head; i++) {
+				const ProfileEvent& event = ring->events[i % RingCapacity];
+				AddSample(m_cpuHistory, event.name, event.end - event.start);
+				Capture(event, ring->id);
+			}
+			ring->tail.store(head, std::memory_order_release);
+		}
+
+		if (m_lastFrame) {
+			ProfileEvent frame;
+			frame.name = "Frame";
+			frame.start = m_lastFrame;
+			frame.end = now;
+			AddSample(m_cpuHistory, frame.name, frame.end - frame.start);
+			Capture(frame, own.id);
+		}
+		m_lastFrame = now;
+	}
+
+	Profiler::History& Profiler::HistoryTable::Get(const char *name)
+	{
+		auto it = byPointer.find(name);
+		if (it != byPointer.end()) {
+			return *it->second;
+		}
+		History *history = &byName[name];
+		byPointer.emplace(name, history);
+		return *history;
+	}
+
+	void Profiler::AddSample(HistoryTable& table, const char *name, uint64_t duration)
+	{
+		History& history = table.Get(name);
+		history.samples[history.next] = (float)(duration * 1e-6);
+		history.next = (history.next + 1) % HistorySize;
+		history.count = std::min(history.count + 1, HistorySize);
+	}
+
+	void Profiler::Capture(const ProfileEvent& event, uint thread)
+	{
+		if (m_capturing && m_capture.size() < m_captureLimit) {
+			m_capture.push_back({ event, thread });
+		}
+	}
+
+	void Profiler::StartCapture(size_t maxEvents)
+	{
+		m_capture.clear();
+		m_capture.reserve(std::min<size_t>(maxEvents, 1 << 16));
+		m_captureLimit = maxEvents;
+		m_capturing = true;
+	}
+
+	void Profiler::StopCapture()
+	{
+		m_capturing = false;
+	}
+
+	bool Profiler::ExportChromeTrace(const std::string& path)
+	{
+		std::ofstream out(path, std::ios::binary | std::ios::trunc);
+		if (!out) {
+			std::cerr << "Profiler: cannot write " << path << std::endl;
+			return false;
+		}
+
+		// pid 0 holds the CPU threads, pid 1 the GPU. Timestamps are in microseconds
+		out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+		out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,\"tid\":0,\"args\":{\"name\":\"CPU\"}},\n";
+		out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"GPU\"}},\n";
+		out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"GL\"}}";
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			for (const auto& ring : m_rings) {
+				const std::string name = ring->name.empty() ? "Thread " + std::to_string(ring->id) : ring->name;
+				out << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << ring->id << ",\"args\":{\"name\":";
+				WriteJSONString(out, name.c_str());
+				out << "}}";
+			}
+		}
+
+		out.setf(std::ios::fixed);
+		out.precision(3);
+		for (const CapturedEvent& captured : m_capture) {
+			const bool gpu = captured.thread == GPUThread;
+			out << ",\n{\"name\":";
+			WriteJSONString(out, captured.event.name);
+			out << ",\"cat\":\"" << (gpu ? "gpu" : "cpu") << "\",\"ph\":\"X\",\"pid\":" << (gpu ? 1 : 0)
+				<< ",\"tid\":" << (gpu ? 0 : captured.thread)
+				<< ",\"ts\":" << captured.event.start * 1e-3
+				<< ",\"dur\":" << (captured.event.end - captured.event.start) * 1e-3 << "}";
+		}
+		out << "\n]}\n";
+
+		if (!out) {
+			std::cerr << "Profiler: failed writing " << path << std::endl;
+			return false;
+		}
+		return true;
+	}
+
+	std::vector<ScopeStats> Profiler::GetStats()
+	{
+		std::vector<ScopeStats> stats;
+		std::vector<float> sorted;
+		for (uint gpu = 0; gpu < 2; gpu++) {
+			for (const auto& entry : (gpu ? m_gpuHistory : m_cpuHistory).byName) {
+				const History& history = entry.second;
+				if (history.count == 0) {
+					continue;
+				}
+				ScopeStats scope;
+				scope.name = entry.first;
+				scope.gpu = gpu != 0;
+				scope.samples = history.count;
+				scope.last = history.samples[(history.next + HistorySize - 1) % HistorySize];
+
+				sorted.assign(history.samples, history.samples + history.count);
+				std::sort(sorted.begin(), sorted.end());
+				scope.p50 = sorted[(sorted.size() - 1) / 2];
+				scope.p99 = sorted[std::min(sorted.size() - 1, sorted.size() * 99 / 100)];
+				scope.max = sorted.back();
+				stats.push_back(scope);
+			}
+		}
+		std::sort(stats.begin(), stats.end(), [](const ScopeStats& a, const ScopeStats& b) { return a.p50 > b.p50; });
+		return stats;
+	}
+
+	void Profiler::Shutdown()
+	{
+		if (m_gpuOpen > 0) {
+			m_gpuOpen = 1;
+			EndGPU();
+		}
+		for (GPUFrame& frame : m_gpuFrames) {
+			if (!frame.queries.empty()) {
+				glDeleteQueries((GLsizei)frame.queries.size(), frame.queries.data());
+			}
+			frame.queries.clear();
+			frame.scopes.clear();
+		}
+	}
+}
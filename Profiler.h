@@ -0,0 +1,195 @@
+#pragma once
+
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <unordered_map>
+#include <glad/glad.h>
+#include "types.h"
+
+// The macros compile to nothing unless LUMEN_PROFILE is defined. Scope names must outlive the
+// profiler (string literals, __func__), only their pointer is recorded
+#ifdef LUMEN_PROFILE
+#define LUMEN_PROFILE_CONCAT_(a, b)		a##b
+#define LUMEN_PROFILE_CONCAT(a, b)		LUMEN_PROFILE_CONCAT_(a, b)
+#define LUMEN_PROFILE_SCOPE(name)		::Lumen::ProfileScope LUMEN_PROFILE_CONCAT(lumenProfileScope, __LINE__)(name)
+#define LUMEN_PROFILE_FUNCTION()		LUMEN_PROFILE_SCOPE(__func__)
+#define LUMEN_PROFILE_GPU_SCOPE(name)	::Lumen::ProfileGPUScope LUMEN_PROFILE_CONCAT(lumenProfileGPUScope, __LINE__)(name)
+#define LUMEN_PROFILE_THREAD(name)		::Lumen::Profiler::SetThreadName(name)
+#define LUMEN_PROFILE_FRAME()			::Lumen::Profiler::EndFrame()
+#else
+#define LUMEN_PROFILE_SCOPE(name)		((void)0)
+#define LUMEN_PROFILE_FUNCTION()		((void)0)
+#define LUMEN_PROFILE_GPU_SCOPE(name)	((void)0)
+#define LUMEN_PROFILE_THREAD(name)		((void)0)
+#define LUMEN_PROFILE_FRAME()			((void)0)
+#endif
+
+namespace Lumen {
+	struct ProfileEvent {
+		const char *name = nullptr;
+		uint64_t start = 0;		// nanoseconds since the profiler started
+		uint64_t end = 0;
+		uint depth = 0;			// nesting level on its thread
+	};
+
+	// Rolling statistics over the last Profiler::HistorySize calls of a scope, in milliseconds
+	struct ScopeStats {
+		std::string name;
+		bool gpu = false;
+		uint samples = 0;
+		float last = 0.0f;
+		float p50 = 0.0f;
+		float p99 = 0.0f;
+		float max = 0.0f;
+	};
+
+	// Frame profiler. Every thread writes its scopes into its own single producer ring, so
+	// recording never locks; EndFrame(), called once per frame on the GL thread, drains the
+	// rings, updates the per scope statistics and appends to the capture if one is running.
+	// GPU scopes wrap GL_TIME_ELAPSED queries, read back GPUFrameLatency frames later and
+	// only when already available, so the profiler never waits on the GPU. Elapsed queries
+	// cannot nest, GPU scopes opened inside another one only time the CPU side.
+	class Profiler {
+	public:
+		static const uint RingCapacity = 1 << 14;	// events per thread between two EndFrame()
+		static const uint HistorySize = 256;
+		static const uint GPUFrameLatency = 3;
+		static const uint MaxGPUScopes = 64;		// per frame
+
+		// Nanoseconds since the profiler started
+		static uint64_t Now();
+
+		static void SetThreadName(const char *name);
+
+		// Used by ProfileScope and ProfileGPUScope
+		static uint EnterScope();
+		static void LeaveScope(const char *name, uint64_t start, uint depth);
+		static void BeginGPU(const char *name, uint64_t cpuStart);
+		static void EndGPU();
+
+		static void EndFrame();
+
+		// Keeps every event from now on, up to `maxEvents`, for ExportChromeTrace
+		static void StartCapture(size_t maxEvents = 1 << 20);
+		static void StopCapture();
+		static bool IsCapturing() { return m_capturing; }
+		// Chrome trace event JSON, opens in chrome://tracing and ui.perfetto.dev. CPU threads
+		// and the GPU get their own tracks
+		static bool ExportChromeTrace(const std::string& path);
+
+		// Sorted by p50, slowest first. The frame itself is reported as "Frame"
+		static std::vector<ScopeStats> GetStats();
+		static uint64_t GetDroppedEvents() { return m_dropped.load(std::memory_order_relaxed); }
+
+		// Deletes the GL queries, needs the context to still be current
+		static void Shutdown();
+	private:
+		struct ThreadRing {
+			ProfileEvent events[RingCapacity];
+			std::atomic<uint32_t> head { 0 };	// written by the owning thread only
+			std::atomic<uint32_t> tail { 0 };	// written by EndFrame only
+			uint depth = 0;
+			uint id = 0;
+			std::string name;
+		};
+
+		struct GPUScope {
+			const char *name;
+			uint64_t cpuStart;
+			uint query;
+		};
+
+		struct GPUFrame {
+			std::vector<uint> queries;
+			std::vector<GPUScope> scopes;
+		};
+
+		struct CapturedEvent {
+			ProfileEvent event;
+			uint thread;		// ThreadRing::id, ~0u for the GPU
+		};
+
+		struct History {
+			float samples[HistorySize];
+			uint count = 0;
+			uint next = 0;
+		};
+
+		// Looked up by name pointer first, so each event costs no string work; the same name
+		// at different addresses (one copy per translation unit) still lands in one History
+		struct HistoryTable {
+			std::unordered_map<const char *, History *> byPointer;
+			std::unordered_map<std::string, History> byName;
+
+			History& Get(const char *name);
+		};
+
+		static std::mutex m_mutex;		// guards m_rings on registration, recording never takes it
+		static std::vector<std::unique_ptr<ThreadRing>> m_rings;
+		static std::atomic<uint64_t> m_dropped;
+
+		static GPUFrame m_gpuFrames[GPUFrameLatency];
+		static uint m_gpuFrame;
+		static uint m_gpuOpen;			// nesting depth of GPU scopes, only the outermost is timed
+		static bool m_gpuTiming;		// the outermost GPU scope got a query
+
+		static HistoryTable m_cpuHistory;
+		static HistoryTable m_gpuHistory;
+		static uint64_t m_lastFrame;
+
+		static bool m_capturing;
+		static size_t m_captureLimit;
+		static std::vector<CapturedEvent> m_capture;
+	private:
+		static ThreadRing& GetRing();
+		static void AddSample(HistoryTable& table, const char *name, uint64_t duration);
+		static void Capture(const ProfileEvent& event, uint thread);
+		static void CollectGPU(GPUFrame& frame);
+	};
+
+	class ProfileScope {
+	public:
+		ProfileScope(const char *name)
+			: m_name(name), m_start(Profiler::Now()), m_depth(Profiler::EnterScope())
+		{
+		}
+
+		~ProfileScope()
+		{
+			Profiler::LeaveScope(m_name, m_start, m_depth);
+		}
+
+		ProfileScope(const ProfileScope&) = delete;
+		ProfileScope& operator=(const ProfileScope&) = delete;
+
+		uint64_t GetStart() const { return m_start; }
+	private:
+		const char *m_name;
+		uint64_t m_start;
+		uint m_depth;
+	};
+
+	// Times a render pass on both sides. Must open and close on the GL thread
+	class ProfileGPUScope {
+	public:
+		ProfileGPUScope(const char *name)
+			: m_cpu(name)
+		{
+			Profiler::BeginGPU(name, m_cpu.GetStart());
+		}
+
+		~ProfileGPUScope()
+		{
+			Profiler::EndGPU();
+		}
+
+		ProfileGPUScope(const ProfileGPUScope&) = delete;
+		ProfileGPUScope& operator=(const ProfileGPUScope&) = delete;
+	private:
+		ProfileScope m_cpu;
+	};
+}
@@ -0,0 +1,145 @@
+#include "ProgramCache.h"
+
+#include <chrono>
+#include <vector>
+#include <fstream>
+#include <cstdio>
+#include <filesystem>
+
+namespace Lumen {
+	namespace {
+		const uint32_t CacheMagic = 0x32505243;	// "CRP2", entries before compile times were recorded are "CRPL"
+
+		struct CacheHeader {
+			uint32_t magic;
+			uint32_t format;
+			uint32_t length;
+			uint32_t compileMicroseconds;	// what compiling the program from source took
+		};
+
+		std::string GLString(GLenum name)
+		{
+			const char *s = (const char *)glGetString(name);
+			return s ? s : "";
+		}
+	}
+
+	std::string ProgramCache::m_directory = "shadercache";
+	ProgramCache::Stats ProgramCache::m_stats;
+	int ProgramCache::m_supported = -1;
+
+	bool ProgramCache::IsEnabled()
+	{
+		if (m_supported < 0) {
+			int formats = 0;
+			glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+			m_supported = formats > 0;
+		}
+		return m_supported && !m_directory.empty();
+	}
+
+	uint64_t ProgramCache::MakeKey(const std::string& vertSource, const std::string& fragSource, const std::string& defines)
+	{
+		uint64_t hash = HashString(GLString(GL_VENDOR));
+		hash = HashString(GLString(GL_RENDERER), hash);
+		hash = HashString(GLString(GL_VERSION), hash);
+		hash = HashString(defines, hash);
+		hash = HashString(vertSource, hash);
+		return HashString(fragSource, hash);
+	}
+
+	uint ProgramCache::Load(uint64_t key)
+	{
+		if (!IsEnabled()) {
+			return 0;
+		}
+
+		const auto start = std::chrono::steady_clock::now();
+		const std::string path = GetPath(key);
+		std::ifstream file(path, std::ios::binary);
+		if (!file.is_open()) {
+			m_stats.misses++;
+			return 0;
+		}
+
+		// a truncated or padded file is not an entry this cache wrote
+		file.seekg(0, std::ios::end);
+		const std::streamoff fileSize = file.tellg();
+		file.seekg(0, std::ios::beg);
+
+		CacheHeader header;
+		std::vector<char> binary;
+		if (file.read((char *)&header, sizeof(header)) && header.magic == CacheMagic
+			&& header.length > 0 && fileSize == (std::streamoff)(sizeof(header) + header.length)) {
+			binary.resize(header.length);
+			file.read(binary.data(), header.length);
+		}
+		file.close();
+
+		uint program = 0;
+		if (!binary.empty() && file) {
+			program = glCreateProgram();
+			// a binary the driver refuses shows up in the link status
+			glProgramBinary(program, header.format, binary.data(), header.length);
+
+			int success = 0;
+			glGetProgramiv(program, GL_LINK_STATUS, &success);
+			if (!success) {
+				GLCall(glDeleteProgram(program));
+				program = 0;
+			}
+		}
+
+		if (!program) {
+			std::remove(path.c_str());
+			m_stats.rejected++;
+			m_stats.misses++;
+			return 0;
+		}
+
+		const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		m_stats.hits++;
+		m_stats.loadSeconds += seconds;
+		m_stats.savedSeconds += header.compileMicroseconds * 1e-6 - seconds;
+		return program;
+	}
+
+	void ProgramCache::Store(uint64_t key, uint program, double compileSeconds)
+	{
+		m_stats.compileSeconds += compileSeconds;
+		if (!IsEnabled()) {
+			return;
+		}
+
+		int length = 0;
+		glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+		if (length <= 0) {
+			return;
+		}
+
+		std::vector<char> binary(length);
+		GLenum format = 0;
+		GLCall(glGetProgramBinary(program, length, &length, &format, binary.data()));
+
+		std::error_code error;
+		std::filesystem::create_directories(m_directory, error);
+
+		const std::string path = GetPath(key);
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		if (!file.is_open()) {
+			std::cerr << "ProgramCache: failed to write " << path << std::endl;
+			return;
+		}
+
+		const CacheHeader header = { CacheMagic, (uint32_t)format, (uint32_t)length, (uint32_t)(compileSeconds * 1e6) };
+		file.write((const char *)&header, sizeof(header));
+		file.write(binary.data(), length);
+	}
+
+	std::string ProgramCache::GetPath(uint64_t key)
+	{
+		char name[32];
+		std::snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)key);
+		return m_directory + "/" + name;
+	}
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+#include <glad/glad.h>
+#include "types.h"
+#include "Utils.h"
+
+namespace Lumen {
+	// On-disk cache of linked program binaries. Entries are keyed by a hash of the shader
+	// sources, the injected defines and the driver (vendor, renderer, version), so a driver
+	// update simply misses. A binary the driver refuses is deleted and the caller falls back
+	// to compiling from source.
+	class ProgramCache {
+	public:
+		struct Stats {
+			uint hits = 0;
+			uint misses = 0;
+			uint rejected = 0;		// entries found on disk but refused by glProgramBinary
+			double compileSeconds = 0.0;	// spent compiling and linking on misses
+			double loadSeconds = 0.0;		// spent loading binaries on hits
+			double savedSeconds = 0.0;		// compile time recorded with each hit entry - loadSeconds
+		};
+
+		// Empty disables the cache. Created on first store
+		static void SetDirectory(const std::string& directory) { m_directory = directory; }
+		static const std::string& GetDirectory() { return m_directory; }
+		static bool IsEnabled();
+
+		static uint64_t MakeKey(const std::string& vertSource, const std::string& fragSource, const std::string& defines = "");
+
+		// Returns a linked program or 0 on a miss
+		static uint Load(uint64_t key);
+		// Stores the binary of a program linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+		static void Store(uint64_t key, uint program, double compileSeconds);
+
+		static const Stats& GetStats() { return m_stats; }
+		static void ResetStats() { m_stats = Stats(); }
+	private:
+		static std::string m_directory;
+		static Stats m_stats;
+		static int m_supported;		// -1 until queried
+	private:
+		static std::string GetPath(uint64_t key);
+	};
+}
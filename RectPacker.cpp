@@ -0,0 +1,109 @@
+#include "RectPacker.h"
+
+#include <algorithm>
+
+namespace Lumen {
+	RectPacker::RectPacker(uint width, uint height)
+	{
+		Reset(width, height);
+	}
+
+	void RectPacker::Reset(uint width, uint height)
+	{
+		m_width = width;
+		m_height = height;
+		m_usedArea = 0;
+		m_skyline.clear();
+		m_skyline.push_back({ 0, 0, width });
+	}
+
+	bool RectPacker::Fit(size_t index, uint width, uint height, uint& y) const
+	{
+		const uint x = m_skyline[index].x;
+		if (x + width > m_width) {
+			return false;
+		}
+
+		y = 0;
+		uint remaining = width;
+		for (size_t i = index; remaining > 0; i++) {
+			if (i == m_skyline.size()) {
+				return false;
+			}
+			y = std::max(y, m_skyline[i].y);
+			if (y + height > m_height) {
+				return false;
+			}
+			remaining -= std::min(remaining, m_skyline[i].width);
+		}
+		return true;
+	}
+
+	bool RectPacker::Insert(uint width, uint height, uint& x, uint& y)
+	{
+		if (width == 0 || height == 0) {
+			x = y = 0;
+			return true;
+		}
+
+		size_t best = m_skyline.size();
+		uint bestTop = ~0u, bestWidth = ~0u, bestY = 0;
+		for (size_t i = 0; i < m_skyline.size(); i++) {
+			uint top;
+			if (!Fit(i, width, height, top)) {
+				continue;
+			}
+			// lowest top edge first, then the narrowest segment to keep wide ones free
+			if (top + height < bestTop || (top + height == bestTop && m_skyline[i].width < bestWidth)) {
+				best = i;
+				bestTop = top + height;
+				bestWidth = m_skyline[i].width;
+				bestY = top;
+			}
+		}
+		if (best == m_skyline.size()) {
+			return false;
+		}
+
+		x = m_skyline[best].x;
+		y = bestY;
+		m_skyline.insert(m_skyline.begin() + best, { x, y + height, width });
+
+		// trim or drop the segments now covered by the new one
+		const uint right = x + width;
+		for (size_t i = best + 1; i < m_skyline.size(); ) {
+			Segment& segment = m_skyline[i];
+			if (segment.x >= right) {
+				break;
+			}
+			const uint segmentRight = segment.x + segment.width;
+			if (segmentRight <= right) {
+				m_skyline.erase(m_skyline.begin() + i);
+				continue;
+			}
+			segment.width = segmentRight - right;
+			segment.x = right;
+			break;
+		}
+
+		// merge neighbours of equal height
+		for (size_t i = 0; i + 1 < m_skyline.size(); ) {
+			if (m_skyline[i].y == m_skyline[i + 1].y) {
+				m_skyline[i].width += m_skyline[i + 1].width;
+				m_skyline.erase(m_skyline.begin() + i + 1);
+			}
+			else {
+				i++;
+			}
+		}
+
+		m_usedArea += (size_t)width * height;
+		return true;
+	}
+
+	float RectPacker::GetOccupancy() const
+	{
+		const size_t area = (size_t)m_width * m_height;
+		return area ? (float)m_usedArea / area : 0.0f;
+	}
+}
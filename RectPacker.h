@@ -0,0 +1,35 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include "types.h"
+
+namespace Lumen {
+	// Skyline bottom-left packer. Keeps the top edge of everything placed so far as a list of
+	// horizontal segments and puts each rectangle where its top ends lowest.
+	// Inserting in decreasing height order packs noticeably tighter.
+	class RectPacker {
+	public:
+		RectPacker(uint width = 0, uint height = 0);
+
+		void Reset(uint width, uint height);
+		// False when the rectangle does not fit anywhere
+		bool Insert(uint width, uint height, uint& x, uint& y);
+
+		uint GetWidth() const { return m_width; }
+		uint GetHeight() const { return m_height; }
+		// Fraction of the area covered by inserted rectangles
+		float GetOccupancy() const;
+	private:
+		struct Segment {
+			uint x, y, width;
+		};
+
+		uint m_width, m_height;
+		size_t m_usedArea = 0;
+		std::vector<Segment> m_skyline;
+	private:
+		// Top of the skyline under [segment.x, segment.x + width), or false if it does not fit
+		bool Fit(size_t index, uint width, uint height, uint& y) const;
+	};
+}
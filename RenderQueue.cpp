@@ -0,0 +1,132 @@
+#include "RenderQueue.h"
+
+namespace Lumen {
+	RenderQueue::RenderQueue(const std::string& transformUniform)
+		: m_transformUniform(transformUniform)
+	{
+	}
+
+	void RenderQueue::Reserve(size_t count)
+	{
+		m_commands.reserve(count);
+		m_keys.reserve(count);
+		m_order.reserve(count);
+		m_scratch.reserve(count);
+	}
+
+	void RenderQueue::Submit(const RenderCommand& command)
+	{
+		m_keys.push_back(MakeKey(command.shader ? command.shader->GetID() : 0,
+								 command.texture ? command.texture->GetID() : 0,
+								 command.vertexArray ? command.vertexArray->GetID() : 0,
+								 command.depth));
+		m_commands.push_back(command);
+	}
+
+	void RenderQueue::Clear()
+	{
+		m_commands.clear();
+		m_keys.clear();
+	}
+
+	uint64_t RenderQueue::MakeKey(uint shader, uint texture, uint vertexArray, float depth)
+	{
+		if (depth < 0.0f) depth = 0.0f;
+		if (depth > 1.0f) depth = 1.0f;
+		const uint64_t d = (uint64_t)(depth * 65535.0f);
+
+		return ((uint64_t)(shader & 0xFFFF) << 48) |
+			   ((uint64_t)(texture & 0xFFFF) << 32) |
+			   ((uint64_t)(vertexArray & 0xFFFF) << 16) |
+			   d;
+	}
+
+	void RenderQueue::Flush()
+	{
+		m_stats = Stats();
+		Sort();
+
+		const Shader *shader = nullptr;
+		const Texture *texture = nullptr;
+		uint textureSlot = 0;
+		const VertexArray *vertexArray = nullptr;
+		Shader::Uniform transform;
+		uint requested = 0;
+
+		for (uint index : m_order) {
+			RenderCommand& cmd = m_commands[index];
+			if (!cmd.vertexArray || !cmd.vertexArray->GetIndexBuffer()) {
+				continue;
+			}
+
+			if (cmd.shader) {
+				requested++;
+				if (cmd.shader != shader) {
+					cmd.shader->Bind();
+					shader = cmd.shader;
+					transform = cmd.shader->GetUniform(m_transformUniform);
+					m_stats.stateChanges++;
+				}
+			}
+			if (cmd.texture) {
+				requested++;
+				if (cmd.texture != texture || cmd.textureSlot != textureSlot) {
+					cmd.texture->Bind(cmd.textureSlot);
+					texture = cmd.texture;
+					textureSlot = cmd.textureSlot;
+					m_stats.stateChanges++;
+				}
+			}
+			requested++;
+			if (cmd.vertexArray.get() != vertexArray) {
+				cmd.vertexArray->Bind();
+				vertexArray = cmd.vertexArray.get();
+				m_stats.stateChanges++;
+			}
+
+			if (cmd.transform && cmd.shader) {
+				transform.SetMat4(*cmd.transform);
+			}
+
+			Renderer::DrawIndexed(cmd.vertexArray, cmd.mode, cmd.type);
+			m_stats.draws++;
+		}
+
+		m_stats.stateChangesAvoided = requested - m_stats.stateChanges;
+		Clear();
+	}
+
+	void RenderQueue::Sort()
+	{
+		const size_t count = m_keys.size();
+		m_order.resize(count);
+		m_scratch.resize(count);
+		for (uint i = 0; i < count; i++) {
+			m_order[i] = i;
+		}
+
+		// LSD radix sort on the keys, one byte per pass; passes where every key
+		// shares the same byte are skipped, which is most of them for small id ranges
+		for (uint shift = 0; shift < 64; shift += 8) {
+			size_t histogram[256] = { };
+			for (size_t i = 0; i < count; i++) {
+				histogram[(m_keys[i] >> shift) & 0xFF]++;
+			}
+			if (count == 0 || histogram[(m_keys[0] >> shift) & 0xFF] == count) {
+				continue;
+			}
+
+			size_t offset = 0;
+			for (size_t& bucket : histogram) {
+				const size_t n = bucket;
+				bucket = offset;
+				offset += n;
+			}
+			for (size_t i = 0; i < count; i++) {
+				const uint index = m_order[i];
+				m_scratch[histogram[(m_keys[index] >> shift) & 0xFF]++] = index;
+			}
+			m_order.swap(m_scratch);
+		}
+	}
+}
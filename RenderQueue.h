@@ -0,0 +1,59 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <cstdint>
+#include "types.h"
+#include "Math.h"
+#include "Shader.h"
+#include "Textures.h"
+#include "VertexArray.h"
+#include "Renderer.h"
+
+namespace Lumen {
+	struct RenderCommand {
+		Shader *shader = nullptr;
+		const Texture *texture = nullptr;
+		std::shared_ptr<VertexArray> vertexArray;
+		const cx::Mat4 *transform = nullptr;	// uploaded to the queue's transform uniform when set
+		float depth = 0.0f;						// view depth normalized to [0, 1], smaller draws first
+		uint textureSlot = 0;
+		int mode = GL_TRIANGLES;
+		int type = 0;							// 0 uses the index buffer's own type
+	};
+
+	// Deferred draw list. Commands are sorted by a 64-bit key
+	// | shader 16 | texture 16 | vertex array 16 | depth 16 |
+	// so draws sharing state end up adjacent, then submitted skipping redundant binds.
+	class RenderQueue {
+	public:
+		struct Stats {
+			uint draws = 0;
+			uint stateChanges = 0;
+			uint stateChangesAvoided = 0;	// binds a naive bind-everything-per-draw loop would have issued on top
+		};
+
+		RenderQueue(const std::string& transformUniform = "u_Model");
+
+		void Reserve(size_t count);
+		void Submit(const RenderCommand& command);
+		// Sorts, draws and clears the queue
+		void Flush();
+		void Clear();
+
+		size_t GetSize() const { return m_commands.size(); }
+		const Stats& GetStats() const { return m_stats; }
+
+		static uint64_t MakeKey(uint shader, uint texture, uint vertexArray, float depth);
+	private:
+		std::string m_transformUniform;
+		std::vector<RenderCommand> m_commands;
+		std::vector<uint64_t> m_keys;
+		std::vector<uint> m_order;
+		std::vector<uint> m_scratch;
+		Stats m_stats;
+	private:
+		void Sort();
+	};
+}
@@ -1,6 +1,8 @@
 #include "Renderer.h"
 
 namespace Lumen {
+	Renderer::Stats Renderer::m_stats;
+
 	void Renderer::Clear(uint mask)
 	{
         GLCall(glClear(mask));
@@ -13,6 +15,56 @@ namespace Lumen {
 
 	void Renderer::DrawIndexed(const std::shared_ptr<VertexArray>& va, int mode, int type)
 	{
-		GLCall(glDrawElements(mode, va->GetIndexBuffer()->GetSize(), type, nullptr));
+		const IndexBuffer& indices = *va->GetIndexBuffer();
+		const GLenum indexType = type ? (GLenum)type : indices.GetType();
+		GLCall(glDrawElements(mode, indices.GetSize() / IndexBuffer::GetTypeSize(indexType), indexType, nullptr));
+		m_stats.drawCalls++;
+		m_stats.commands++;
+	}
+
+	void Renderer::DrawIndexed(uint count, uint indexOffset, int baseVertex, int mode, int type)
+	{
+		GLCall(glDrawElementsBaseVertex(mode, count, type, (const void*)(size_t)indexOffset, baseVertex));
+		m_stats.drawCalls++;
+		m_stats.commands++;
+	}
+
+	void Renderer::DrawArrays(uint first, uint count, int mode)
+	{
+		GLCall(glDrawArrays(mode, first, count));
+		m_stats.drawCalls++;
+		m_stats.commands++;
+	}
+
+	void Renderer::DrawIndexedInstanced(const std::shared_ptr<VertexArray>& va, uint instanceCount, int mode, int type)
+	{
+		if (instanceCount == 0) {
+			return;
+		}
+		const IndexBuffer& indices = *va->GetIndexBuffer();
+		const GLenum indexType = type ? (GLenum)type : indices.GetType();
+		GLCall(glDrawElementsInstanced(mode, indices.GetSize() / IndexBuffer::GetTypeSize(indexType), indexType, nullptr, instanceCount));
+		m_stats.drawCalls++;
+		m_stats.commands++;
+	}
+
+	void Renderer::DrawIndexedInstanced(uint count, uint indexOffset, int baseVertex, uint instanceCount, int mode, int type)
+	{
+		if (instanceCount == 0) {
+			return;
+		}
+		GLCall(glDrawElementsInstancedBaseVertex(mode, count, type, (const void*)(size_t)indexOffset, instanceCount, baseVertex));
+		m_stats.drawCalls++;
+		m_stats.commands++;
+	}
+
+	void Renderer::MultiDrawIndexedIndirect(uint drawCount, uint commandOffset, int mode, int type)
+	{
+		if (drawCount == 0) {
+			return;
+		}
+		GLCall(GLExtensions::MultiDrawElementsIndirect(mode, type, (const void*)(size_t)commandOffset, drawCount, 0));
+		m_stats.drawCalls++;
+		m_stats.commands += drawCount;
 	}
 }
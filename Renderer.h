@@ -3,13 +3,37 @@
 #include <iostream>
 #include <glad/glad.h>
 #include "VertexArray.h"
+#include "GLExtensions.h"
 #include "Utils.h"
 
 namespace Lumen {
 	class Renderer {
 	public:
+		// Counted by every Draw* call. `commands` is how many meshes were drawn, which equals
+		// `drawCalls` for the classic entry points and is far larger for the indirect ones
+		struct Stats {
+			uint drawCalls = 0;
+			uint commands = 0;
+		};
+
 		static void Clear(uint mask = GL_COLOR_BUFFER_BIT);
 		static void ClearColor(float red = 0.0, float green = 0.0, float blue = 0.0, float alpha = 1.0);
-		static void DrawIndexed(const std::shared_ptr<VertexArray>& va, int mode = GL_TRIANGLES, int type = GL_UNSIGNED_INT);
+		// Draws the whole index buffer of `va`. A type of 0 uses the index buffer's own type
+		static void DrawIndexed(const std::shared_ptr<VertexArray>& va, int mode = GL_TRIANGLES, int type = 0);
+		// Draws `count` indices starting `indexOffset` bytes into the bound element buffer, e.g. from a StreamBuffer span
+		static void DrawIndexed(uint count, uint indexOffset, int baseVertex = 0, int mode = GL_TRIANGLES, int type = GL_UNSIGNED_INT);
+		static void DrawArrays(uint first, uint count, int mode = GL_TRIANGLES);
+		// Per-instance attributes come from buffers added with a VertexBufferLayout divisor
+		static void DrawIndexedInstanced(const std::shared_ptr<VertexArray>& va, uint instanceCount, int mode = GL_TRIANGLES, int type = 0);
+		static void DrawIndexedInstanced(uint count, uint indexOffset, int baseVertex, uint instanceCount, int mode = GL_TRIANGLES, int type = GL_UNSIGNED_INT);
+		// Issues `drawCount` DrawElementsIndirectCommands read from the bound GL_DRAW_INDIRECT_BUFFER
+		// at `commandOffset`. Requires GLExtensions::HasMultiDrawIndirect()
+		static void MultiDrawIndexedIndirect(uint drawCount, uint commandOffset, int mode = GL_TRIANGLES, int type = GL_UNSIGNED_INT);
+
+		static const Stats& GetStats() { return m_stats; }
+		// Call once per frame to get per-frame numbers
+		static void ResetStats() { m_stats = Stats(); }
+	private:
+		static Stats m_stats;
 	};
 }
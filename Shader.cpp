@@ -1,69 +1,39 @@
 #include "Shader.h"
 
+#include <chrono>
 #include <glad/glad.h>
 
 namespace Lumen {
 	Shader::Shader(const std::string& vert, const std::string& frag)
 	{
-		std::string vertSource = readShaderSource(vert);
-		std::string fragSource = readShaderSource(frag);
-
-		const char* vertexSrc = vertSource.c_str();
-		const char* fragmentSrc = fragSource.c_str();
-
-		int success;
-		char infoLog[512];
-
-		uint vertex = GLCall(glCreateShader(GL_VERTEX_SHADER));
-		uint fragment = GLCall(glCreateShader(GL_FRAGMENT_SHADER));
-
-		GLCall(glShaderSource(vertex, 1, &vertexSrc, NULL));
-		GLCall(glCompileShader(vertex));
-
-		glGetShaderiv(vertex, GL_COMPILE_STATUS, &success);
-		if (!success) {
-			glGetShaderInfoLog(vertex, 512, NULL, infoLog);
-			std::cerr << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" << infoLog << std::endl;
-		}
-
-		GLCall(glShaderSource(fragment, 1, &fragmentSrc, NULL));
-		GLCall(glCompileShader(fragment));
-
-		glGetShaderiv(fragment, GL_COMPILE_STATUS, &success);
-		if (!success) {
-			glGetShaderInfoLog(fragment, 512, NULL, infoLog);
-			std::cerr << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n" << infoLog << std::endl;
-		}
-
-
-		m_id = GLCall(glCreateProgram());
-		GLCall(glAttachShader(m_id, vertex));
-		GLCall(glAttachShader(m_id, fragment));
-		GLCall(glLinkProgram(m_id));
+		create({ readShaderSource(vert), readShaderSource(frag), "" });
+	}
 
-		glGetProgramiv(m_id, GL_LINK_STATUS, &success);
-		if (!success) {
-			glGetProgramInfoLog(m_id, 512, NULL, infoLog);
-			std::cerr << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
-		}
+	Shader::Shader(const ShaderSource& source)
+	{
+		create(source);
+	}
 
-		GLCall(glDeleteShader(vertex));
-		GLCall(glDeleteShader(fragment));
+	Shader::Shader(uint program)
+		: m_id(program)
+	{
+		reflectUniformBlocks();
 	}
 
 	Shader::~Shader()
 	{
 		GLCall(glDeleteProgram(m_id));
+		GLState::DeleteProgram(m_id);
 	}
 
 	void Shader::Bind() const
 	{
-		GLCall(glUseProgram(m_id));
+		GLState::UseProgram(m_id);
 	}
 
 	void Shader::Unbind() const
 	{
-		GLCall(glUseProgram(0));
+		GLState::UseProgram(0);
 	}
 
 	void Shader::SetUniform1f(const std::string& name, const float v1)
@@ -174,6 +144,181 @@ namespace Lumen {
 		GLCall(glUniformMatrix4fv(loc, 1, GL_TRUE, v1.data()));
 	}
 
+	void Shader::Uniform::Set1f(const float v1) const
+	{
+		GLCall(glUniform1f(m_location, v1));
+	}
+
+	void Shader::Uniform::Set2f(const float v1, const float v2) const
+	{
+		GLCall(glUniform2f(m_location, v1, v2));
+	}
+
+	void Shader::Uniform::Set3f(const float v1, const float v2, const float v3) const
+	{
+		GLCall(glUniform3f(m_location, v1, v2, v3));
+	}
+
+	void Shader::Uniform::Set4f(const float v1, const float v2, const float v3, const float v4) const
+	{
+		GLCall(glUniform4f(m_location, v1, v2, v3, v4));
+	}
+
+	void Shader::Uniform::Set1i(const int v1) const
+	{
+		GLCall(glUniform1i(m_location, v1));
+	}
+
+	void Shader::Uniform::Set2i(const int v1, const int v2) const
+	{
+		GLCall(glUniform2i(m_location, v1, v2));
+	}
+
+	void Shader::Uniform::Set3i(const int v1, const int v2, const int v3) const
+	{
+		GLCall(glUniform3i(m_location, v1, v2, v3));
+	}
+
+	void Shader::Uniform::Set4i(const int v1, const int v2, const int v3, const int v4) const
+	{
+		GLCall(glUniform4i(m_location, v1, v2, v3, v4));
+	}
+
+	void Shader::Uniform::Set1ui(const uint v1) const
+	{
+		GLCall(glUniform1ui(m_location, v1));
+	}
+
+	void Shader::Uniform::Set2ui(const uint v1, const uint v2) const
+	{
+		GLCall(glUniform2ui(m_location, v1, v2));
+	}
+
+	void Shader::Uniform::Set3ui(const uint v1, const uint v2, const uint v3) const
+	{
+		GLCall(glUniform3ui(m_location, v1, v2, v3));
+	}
+
+	void Shader::Uniform::Set4ui(const uint v1, const uint v2, const uint v3, const uint v4) const
+	{
+		GLCall(glUniform4ui(m_location, v1, v2, v3, v4));
+	}
+
+	void Shader::Uniform::SetVec2(const cx::Vec2& v1) const
+	{
+		GLCall(glUniform2fv(m_location, 1, v1.data()));
+	}
+
+	void Shader::Uniform::SetVec3(const cx::Vec3& v1) const
+	{
+		GLCall(glUniform3fv(m_location, 1, v1.data()));
+	}
+
+	void Shader::Uniform::SetVec4(const cx::Vec4& v1) const
+	{
+		GLCall(glUniform4fv(m_location, 1, v1.data()));
+	}
+
+	void Shader::Uniform::SetMat2(const cx::Mat2& v1) const
+	{
+		GLCall(glUniformMatrix2fv(m_location, 1, GL_TRUE, v1.data()));
+	}
+
+	void Shader::Uniform::SetMat3(const cx::Mat3& v1) const
+	{
+		GLCall(glUniformMatrix3fv(m_location, 1, GL_TRUE, v1.data()));
+	}
+
+	void Shader::Uniform::SetMat4(const cx::Mat4& v1) const
+	{
+		GLCall(glUniformMatrix4fv(m_location, 1, GL_TRUE, v1.data()));
+	}
+
+	const UniformBlock *Shader::FindUniformBlock(const std::string& name) const
+	{
+		for (const UniformBlock& block : m_uniformBlocks) {
+			if (block.name == name) {
+				return &block;
+			}
+		}
+		return nullptr;
+	}
+
+	void Shader::SetUniformBlockBinding(const std::string& name, uint binding)
+	{
+		const UniformBlock *block = FindUniformBlock(name);
+		if (!block) {
+			std::cout << "Warning: Uniform block '" << name << "' not found." << std::endl;
+			return;
+		}
+		GLCall(glUniformBlockBinding(m_id, block->index, binding));
+	}
+
+	void Shader::create(const ShaderSource& source)
+	{
+		const uint64_t key = ProgramCache::MakeKey(source.vertex, source.fragment, source.defines);
+		m_id = ProgramCache::Load(key);
+		if (m_id) {
+			reflectUniformBlocks();
+			return;
+		}
+
+		const auto start = std::chrono::steady_clock::now();
+		if (compileProgram(source.vertex, source.fragment)) {
+			const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			ProgramCache::Store(key, m_id, seconds);
+			reflectUniformBlocks();
+		}
+	}
+
+	bool Shader::compileProgram(const std::string& vertSource, const std::string& fragSource)
+	{
+		const char* vertexSrc = vertSource.c_str();
+		const char* fragmentSrc = fragSource.c_str();
+
+		int success;
+		char infoLog[512];
+
+		uint vertex = glCreateShader(GL_VERTEX_SHADER);
+		uint fragment = glCreateShader(GL_FRAGMENT_SHADER);
+
+		// issue both compiles before asking for either status, a status query waits for the compile
+		GLCall(glShaderSource(vertex, 1, &vertexSrc, NULL));
+		GLCall(glCompileShader(vertex));
+		GLCall(glShaderSource(fragment, 1, &fragmentSrc, NULL));
+		GLCall(glCompileShader(fragment));
+
+		glGetShaderiv(vertex, GL_COMPILE_STATUS, &success);
+		if (!success) {
+			glGetShaderInfoLog(vertex, 512, NULL, infoLog);
+			std::cerr << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" << infoLog << std::endl;
+		}
+
+		glGetShaderiv(fragment, GL_COMPILE_STATUS, &success);
+		if (!success) {
+			glGetShaderInfoLog(fragment, 512, NULL, infoLog);
+			std::cerr << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n" << infoLog << std::endl;
+		}
+
+		m_id = glCreateProgram();
+		// lets ProgramCache read the binary back after linking
+		GLCall(glProgramParameteri(m_id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE));
+		GLCall(glAttachShader(m_id, vertex));
+		GLCall(glAttachShader(m_id, fragment));
+		GLCall(glLinkProgram(m_id));
+
+		glGetProgramiv(m_id, GL_LINK_STATUS, &success);
+		if (!success) {
+			glGetProgramInfoLog(m_id, 512, NULL, infoLog);
+			std::cerr << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
+		}
+
+		GLCall(glDeleteShader(vertex));
+		GLCall(glDeleteShader(fragment));
+
+		return success != 0;
+	}
+
 	std::string Shader::readShaderSource(const std::string& filePath)
 	{
 		std::ifstream file(filePath);
@@ -189,11 +334,12 @@ namespace Lumen {
 
 	int Shader::getUniformLocation(const std::string& name)
 	{
-		if (m_UniformLocationCache.find(name) != m_UniformLocationCache.end()) {
-			return m_UniformLocationCache[name];
+		auto it = m_UniformLocationCache.find(name);
+		if (it != m_UniformLocationCache.end()) {
+			return it->second;
 		}
 
-		int loc = GLCall(glGetUniformLocation(m_id, name.c_str()));
+		int loc = glGetUniformLocation(m_id, name.c_str());
 		if (loc == -1) {
 			std::cout << "Warning: Uniform '" << name << "' not found." << std::endl;
 		}
@@ -201,4 +347,51 @@ namespace Lumen {
 
 		return loc;
 	}
+
+	void Shader::reflectUniformBlocks()
+	{
+		int blockCount = 0;
+		glGetProgramiv(m_id, GL_ACTIVE_UNIFORM_BLOCKS, &blockCount);
+
+		char name[256];
+		for (int b = 0; b < blockCount; b++) {
+			UniformBlock block;
+			int size = 0, memberCount = 0;
+			glGetActiveUniformBlockName(m_id, b, sizeof(name), NULL, name);
+			glGetActiveUniformBlockiv(m_id, b, GL_UNIFORM_BLOCK_DATA_SIZE, &size);
+			glGetActiveUniformBlockiv(m_id, b, GL_UNIFORM_BLOCK_ACTIVE_UNIFORMS, &memberCount);
+			block.name = name;
+			block.index = b;
+			block.size = size;
+
+			if (memberCount > 0) {
+				std::vector<int> indices(memberCount);
+				glGetActiveUniformBlockiv(m_id, b, GL_UNIFORM_BLOCK_ACTIVE_UNIFORM_INDICES, indices.data());
+
+				const uint* uindices = (const uint*)indices.data();
+				std::vector<int> types(memberCount), sizes(memberCount), offsets(memberCount);
+				std::vector<int> arrayStrides(memberCount), matrixStrides(memberCount), rowMajor(memberCount);
+				glGetActiveUniformsiv(m_id, memberCount, uindices, GL_UNIFORM_TYPE, types.data());
+				glGetActiveUniformsiv(m_id, memberCount, uindices, GL_UNIFORM_SIZE, sizes.data());
+				glGetActiveUniformsiv(m_id, memberCount, uindices, GL_UNIFORM_OFFSET, offsets.data());
+				glGetActiveUniformsiv(m_id, memberCount, uindices, GL_UNIFORM_ARRAY_STRIDE, arrayStrides.data());
+				glGetActiveUniformsiv(m_id, memberCount, uindices, GL_UNIFORM_MATRIX_STRIDE, matrixStrides.data());
+				glGetActiveUniformsiv(m_id, memberCount, uindices, GL_UNIFORM_IS_ROW_MAJOR, rowMajor.data());
+
+				for (int i = 0; i < memberCount; i++) {
+					UniformBlockMember member;
+					glGetActiveUniformName(m_id, uindices[i], sizeof(name), NULL, name);
+					member.name = name;
+					member.type = types[i];
+					member.arraySize = arrayStrides[i] > 0 ? sizes[i] : 0;
+					member.field.offset = offsets[i];
+					member.field.arrayStride = arrayStrides[i];
+					member.field.matrixStride = matrixStrides[i];
+					member.field.rowMajor = rowMajor[i] != 0;
+					block.members.push_back(member);
+				}
+			}
+			m_uniformBlocks.push_back(block);
+		}
+	}
 }
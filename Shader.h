@@ -5,17 +5,64 @@
 #include <sstream>
 #include "types.h"
 #include "Utils.h"
+#include "GLState.h"
+#include "UniformBuffer.h"
+#include "ProgramCache.h"
 
 #include "Math.h"
 
 namespace Lumen {
+	// Already loaded (and preprocessed) stage sources. `defines` only feeds the program cache key
+	struct ShaderSource {
+		std::string vertex;
+		std::string fragment;
+		std::string defines;
+	};
+
 	class Shader {
 	public:
+		// Resolved uniform location of a program. Look it up once with GetUniform() and keep
+		// it, setting through the handle skips the name lookup. The program must be bound
+		class Uniform {
+		public:
+			Uniform(int location = -1) : m_location(location) {}
+
+			bool IsValid() const { return m_location != -1; }
+			int GetLocation() const { return m_location; }
+
+			void Set1f(const float v1) const;
+			void Set2f(const float v1, const float v2) const;
+			void Set3f(const float v1, const float v2, const float v3) const;
+			void Set4f(const float v1, const float v2, const float v3, const float v4) const;
+
+			void Set1i(const int v1) const;
+			void Set2i(const int v1, const int v2) const;
+			void Set3i(const int v1, const int v2, const int v3) const;
+			void Set4i(const int v1, const int v2, const int v3, const int v4) const;
+
+			void Set1ui(const uint v1) const;
+			void Set2ui(const uint v1, const uint v2) const;
+			void Set3ui(const uint v1, const uint v2, const uint v3) const;
+			void Set4ui(const uint v1, const uint v2, const uint v3, const uint v4) const;
+
+			void SetVec2(const cx::Vec2& v1) const;
+			void SetVec3(const cx::Vec3& v1) const;
+			void SetVec4(const cx::Vec4& v1) const;
+
+			void SetMat2(const cx::Mat2& v1) const;
+			void SetMat3(const cx::Mat3& v1) const;
+			void SetMat4(const cx::Mat4& v1) const;
+		private:
+			int m_location;
+		};
+
 		Shader(const std::string& vert, const std::string& frag);
+		Shader(const ShaderSource& source);
 		~Shader();
 
 		void Bind() const;
 		void Unbind() const;
+		uint GetID() const { return m_id; }
 
 		void SetUniform1f(const std::string& name, const float v1);
 		void SetUniform2f(const std::string& name, const float v1, const float v2);
@@ -39,12 +86,27 @@ namespace Lumen {
 		void SetUniformMat2(const std::string& name, const cx::Mat2& v1);
 		void SetUniformMat3(const std::string& name, const cx::Mat3& v1);
 		void SetUniformMat4(const std::string& name, const cx::Mat4& v1);
+
+		Uniform GetUniform(const std::string& name) { return Uniform(getUniformLocation(name)); }
+
+		// Uniform blocks of the linked program, reflected once after linking
+		const std::vector<UniformBlock>& GetUniformBlocks() const { return m_uniformBlocks; }
+		const UniformBlock *FindUniformBlock(const std::string& name) const;
+		void SetUniformBlockBinding(const std::string& name, uint binding);
 	private:
+		friend class ShaderCompiler;
+		// Adopts a program that is already linked
+		explicit Shader(uint program);
+
 		uint m_id;
 		std::unordered_map<std::string, int> m_UniformLocationCache;
+		std::vector<UniformBlock> m_uniformBlocks;
 
 	private:
 		std::string readShaderSource(const std::string& filePath);
+		void create(const ShaderSource& source);
+		bool compileProgram(const std::string& vertSource, const std::string& fragSource);
 		int getUniformLocation(const std::string& name);
+		void reflectUniformBlocks();
 	};
 }
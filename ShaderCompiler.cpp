@@ -0,0 +1,168 @@
+#include "ShaderCompiler.h"
+
+#include "ShaderPreprocessor.h"
+
+namespace Lumen {
+	ShaderFuture::State::~State()
+	{
+		if (vertex) {
+			glDeleteShader(vertex);
+		}
+		if (fragment) {
+			glDeleteShader(fragment);
+		}
+		if (program && !shader) {
+			glDeleteProgram(program);
+		}
+	}
+
+	bool ShaderFuture::IsReady() const
+	{
+		return m_state && ShaderCompiler::Advance(*m_state, false);
+	}
+
+	bool ShaderFuture::HasFailed() const
+	{
+		return m_state && m_state->stage == Stage::Failed;
+	}
+
+	std::shared_ptr<Shader> ShaderFuture::Get() const
+	{
+		if (!m_state) {
+			return nullptr;
+		}
+		ShaderCompiler::Advance(*m_state, true);
+		return m_state->shader;
+	}
+
+	ShaderFuture ShaderCompiler::Compile(const ShaderSource& source)
+	{
+		ShaderFuture future;
+		future.m_state = std::make_shared<ShaderFuture::State>();
+		ShaderFuture::State& state = *future.m_state;
+
+		state.key = ProgramCache::MakeKey(source.vertex, source.fragment, source.defines);
+		if (uint program = ProgramCache::Load(state.key)) {
+			state.shader = std::shared_ptr<Shader>(new Shader(program));
+			state.stage = ShaderFuture::Stage::Done;
+			return future;
+		}
+
+		state.start = std::chrono::steady_clock::now();
+		const char *vertexSrc = source.vertex.c_str();
+		const char *fragmentSrc = source.fragment.c_str();
+		state.vertex = glCreateShader(GL_VERTEX_SHADER);
+		state.fragment = glCreateShader(GL_FRAGMENT_SHADER);
+		GLCall(glShaderSource(state.vertex, 1, &vertexSrc, NULL));
+		GLCall(glCompileShader(state.vertex));
+		GLCall(glShaderSource(state.fragment, 1, &fragmentSrc, NULL));
+		GLCall(glCompileShader(state.fragment));
+		return future;
+	}
+
+	ShaderFuture ShaderCompiler::Compile(const std::string& vert, const std::string& frag)
+	{
+		ShaderPreprocessor preprocessor;
+		ShaderSource source;
+		source.vertex = preprocessor.Process(vert, ShaderDefines());
+		source.fragment = preprocessor.Process(frag, ShaderDefines());
+		if (source.vertex.empty() || source.fragment.empty()) {
+			ShaderFuture future;
+			future.m_state = std::make_shared<ShaderFuture::State>();
+			future.m_state->stage = ShaderFuture::Stage::Failed;
+			return future;
+		}
+		return Compile(source);
+	}
+
+	void ShaderCompiler::SetMaxThreads(uint count)
+	{
+		if (GLExtensions::MaxShaderCompilerThreads) {
+			GLCall(GLExtensions::MaxShaderCompilerThreads(count));
+		}
+	}
+
+	bool ShaderCompiler::IsComplete(uint object, bool program)
+	{
+		if (!GLExtensions::HasParallelShaderCompile()) {
+			return true;
+		}
+		int complete = GL_FALSE;
+		if (program) {
+			glGetProgramiv(object, GL_COMPLETION_STATUS_KHR, &complete);
+		}
+		else {
+			glGetShaderiv(object, GL_COMPLETION_STATUS_KHR, &complete);
+		}
+		return complete == GL_TRUE;
+	}
+
+	bool ShaderCompiler::Advance(ShaderFuture::State& state, bool wait)
+	{
+		using Stage = ShaderFuture::Stage;
+
+		int success;
+		char infoLog[512];
+
+		if (state.stage == Stage::Compiling) {
+			if (!wait && !(IsComplete(state.vertex, false) && IsComplete(state.fragment, false))) {
+				return false;
+			}
+
+			glGetShaderiv(state.vertex, GL_COMPILE_STATUS, &success);
+			if (!success) {
+				glGetShaderInfoLog(state.vertex, 512, NULL, infoLog);
+				std::cerr << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" << infoLog << std::endl;
+			}
+			int fragmentSuccess;
+			glGetShaderiv(state.fragment, GL_COMPILE_STATUS, &fragmentSuccess);
+			if (!fragmentSuccess) {
+				glGetShaderInfoLog(state.fragment, 512, NULL, infoLog);
+				std::cerr << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n" << infoLog << std::endl;
+			}
+
+			if (success && fragmentSuccess) {
+				state.program = glCreateProgram();
+				GLCall(glProgramParameteri(state.program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE));
+				GLCall(glAttachShader(state.program, state.vertex));
+				GLCall(glAttachShader(state.program, state.fragment));
+				GLCall(glLinkProgram(state.program));
+			}
+
+			// attached shaders are only flagged, the driver frees them with the program
+			GLCall(glDeleteShader(state.vertex));
+			GLCall(glDeleteShader(state.fragment));
+			state.vertex = 0;
+			state.fragment = 0;
+
+			state.stage = state.program ? Stage::Linking : Stage::Failed;
+			if (!wait && !GLExtensions::HasParallelShaderCompile()) {
+				// without the extension the link status query below would stall, leave it for the next poll
+				return false;
+			}
+		}
+
+		if (state.stage == Stage::Linking) {
+			if (!wait && !IsComplete(state.program, true)) {
+				return false;
+			}
+
+			glGetProgramiv(state.program, GL_LINK_STATUS, &success);
+			if (!success) {
+				glGetProgramInfoLog(state.program, 512, NULL, infoLog);
+				std::cerr << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
+				GLCall(glDeleteProgram(state.program));
+				state.program = 0;
+				state.stage = Stage::Failed;
+				return true;
+			}
+
+			const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - state.start).count();
+			ProgramCache::Store(state.key, state.program, seconds);
+			state.shader = std::shared_ptr<Shader>(new Shader(state.program));
+			state.stage = Stage::Done;
+		}
+
+		return true;
+	}
+}
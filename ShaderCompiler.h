@@ -0,0 +1,65 @@
+#pragma once
+
+#include <memory>
+#include <chrono>
+#include "types.h"
+#include "Shader.h"
+#include "ProgramCache.h"
+#include "GLExtensions.h"
+
+namespace Lumen {
+	// Handle to a program being compiled by ShaderCompiler. Copies share the same compile.
+	// IsReady() never stalls when the driver has parallel shader compile, Get() always can.
+	class ShaderFuture {
+	public:
+		ShaderFuture() = default;
+
+		bool IsValid() const { return m_state != nullptr; }
+		// Advances the compile without blocking; true once Get() would return immediately
+		bool IsReady() const;
+		bool HasFailed() const;
+		// Finishes the compile, waiting for the driver if needed. nullptr when it failed
+		std::shared_ptr<Shader> Get() const;
+	private:
+		friend class ShaderCompiler;
+
+		enum class Stage {
+			Compiling,
+			Linking,
+			Done,
+			Failed,
+		};
+
+		struct State {
+			Stage stage = Stage::Compiling;
+			uint vertex = 0;
+			uint fragment = 0;
+			uint program = 0;
+			uint64_t key = 0;
+			std::chrono::steady_clock::time_point start;
+			std::shared_ptr<Shader> shader;
+
+			// releases the GL objects of a compile nobody waited for
+			~State();
+		};
+
+		std::shared_ptr<State> m_state;
+	};
+
+	// Issues every compile up front and lets the driver work through them on its own threads
+	// (KHR_parallel_shader_compile), while the render loop polls the returned handles.
+	// Without the extension each poll moves a handle one stage forward, which does block,
+	// but spreads the cost across frames instead of one long stall.
+	class ShaderCompiler {
+	public:
+		static ShaderFuture Compile(const ShaderSource& source);
+		static ShaderFuture Compile(const std::string& vert, const std::string& frag);
+
+		// Number of driver compiler threads, 0xFFFFFFFF lets the driver decide
+		static void SetMaxThreads(uint count);
+	private:
+		friend class ShaderFuture;
+		static bool Advance(ShaderFuture::State& state, bool wait);
+		static bool IsComplete(uint object, bool program);
+	};
+}
@@ -0,0 +1,59 @@
+#include "ShaderLibrary.h"
+
+namespace Lumen {
+	std::unordered_map<uint64_t, std::weak_ptr<Shader>> ShaderLibrary::m_shared;
+
+	ShaderLibrary::ShaderLibrary(const std::string& vert, const std::string& frag)
+		: m_vert(vert), m_frag(frag)
+	{
+	}
+
+	std::shared_ptr<Shader> ShaderLibrary::Get(const ShaderDefines& defines)
+	{
+		const std::string key = defines.GetKey();
+		auto it = m_permutations.find(key);
+		if (it != m_permutations.end()) {
+			return it->second;
+		}
+
+		ShaderDefines used;
+		ShaderSource source;
+		source.vertex = m_preprocessor.Process(m_vert, defines, &used);
+		source.fragment = m_preprocessor.Process(m_frag, defines, &used);
+		if (source.vertex.empty() || source.fragment.empty()) {
+			return nullptr;
+		}
+		source.defines = used.GetKey();
+
+		const uint64_t hash = HashString(source.fragment, HashString(source.vertex));
+		std::shared_ptr<Shader> shader;
+		auto program = m_programs.find(hash);
+		if (program != m_programs.end()) {
+			shader = program->second;
+		}
+		else {
+			shader = m_shared[hash].lock();
+			if (!shader) {
+				shader = std::make_shared<Shader>(source);
+				m_shared[hash] = shader;
+			}
+			m_programs[hash] = shader;
+		}
+
+		m_permutations[key] = shader;
+		return shader;
+	}
+
+	void ShaderLibrary::Reload()
+	{
+		for (const auto& [hash, shader] : m_programs) {
+			auto it = m_shared.find(hash);
+			if (it != m_shared.end() && it->second.lock() == shader) {
+				m_shared.erase(it);
+			}
+		}
+		m_permutations.clear();
+		m_programs.clear();
+		m_preprocessor.ClearCache();
+	}
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include "types.h"
+#include "Shader.h"
+#include "ShaderPreprocessor.h"
+
+namespace Lumen {
+	// One vertex/fragment source pair and the permutations built from it. A permutation is
+	// preprocessed and compiled the first time its defines are requested; permutations whose
+	// expanded sources hash the same (also across libraries) share one Shader.
+	class ShaderLibrary {
+	public:
+		ShaderLibrary(const std::string& vert, const std::string& frag);
+
+		std::shared_ptr<Shader> Get(const ShaderDefines& defines = ShaderDefines());
+
+		// Drops every permutation and the cached sources, the next Get() rereads the files
+		void Reload();
+		// Distinct programs compiled so far by this library
+		uint GetProgramCount() const { return (uint)m_programs.size(); }
+		uint GetPermutationCount() const { return (uint)m_permutations.size(); }
+	private:
+		std::string m_vert;
+		std::string m_frag;
+		ShaderPreprocessor m_preprocessor;
+		std::unordered_map<std::string, std::shared_ptr<Shader>> m_permutations;	// by requested defines
+		std::unordered_map<uint64_t, std::shared_ptr<Shader>> m_programs;			// by expanded source
+		static std::unordered_map<uint64_t, std::weak_ptr<Shader>> m_shared;
+	};
+}
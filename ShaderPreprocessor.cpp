@@ -0,0 +1,201 @@
+#include "ShaderPreprocessor.h"
+
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <algorithm>
+#include <filesystem>
+
+namespace Lumen {
+	namespace {
+		bool IsIdentifierChar(char c)
+		{
+			return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+		}
+
+		bool ContainsWord(const std::string& text, const std::string& word)
+		{
+			for (size_t pos = text.find(word); pos != std::string::npos; pos = text.find(word, pos + 1)) {
+				const bool startOk = pos == 0 || !IsIdentifierChar(text[pos - 1]);
+				const bool endOk = pos + word.size() == text.size() || !IsIdentifierChar(text[pos + word.size()]);
+				if (startOk && endOk) {
+					return true;
+				}
+			}
+			return false;
+		}
+
+		// If `line` is the directive `name` returns what follows it, otherwise nullptr
+		const char *MatchDirective(const std::string& line, const char *name)
+		{
+			size_t i = line.find_first_not_of(" \t");
+			if (i == std::string::npos || line[i] != '#') {
+				return nullptr;
+			}
+			i = line.find_first_not_of(" \t", i + 1);
+			const size_t length = std::char_traits<char>::length(name);
+			if (i == std::string::npos || line.compare(i, length, name) != 0) {
+				return nullptr;
+			}
+			if (i + length < line.size() && IsIdentifierChar(line[i + length])) {
+				return nullptr;
+			}
+			return line.c_str() + i + length;
+		}
+	}
+
+	ShaderDefines& ShaderDefines::Set(const std::string& name, const std::string& value)
+	{
+		m_defines[name] = value;
+		return *this;
+	}
+
+	ShaderDefines& ShaderDefines::Set(const std::string& name, int value)
+	{
+		return Set(name, std::to_string(value));
+	}
+
+	ShaderDefines& ShaderDefines::Remove(const std::string& name)
+	{
+		m_defines.erase(name);
+		return *this;
+	}
+
+	std::string ShaderDefines::GetKey() const
+	{
+		std::string key;
+		for (const auto& [name, value] : m_defines) {
+			key += name;
+			key += '=';
+			key += value;
+			key += ';';
+		}
+		return key;
+	}
+
+	std::string ShaderPreprocessor::Process(const std::string& path, const ShaderDefines& defines, ShaderDefines *used)
+	{
+		std::string out;
+		std::vector<std::string> stack;
+		std::unordered_set<std::string> once;
+		if (!Expand(std::filesystem::path(path).lexically_normal().string(), out, stack, once)) {
+			return "";
+		}
+
+		// defines go after #version, which has to stay the first statement
+		size_t insert = 0;
+		int versionLine = 0;
+		for (size_t pos = 0; pos < out.size(); ) {
+			size_t end = out.find('\n', pos);
+			end = end == std::string::npos ? out.size() : end + 1;
+			versionLine++;
+			if (MatchDirective(out.substr(pos, end - pos), "version")) {
+				insert = end;
+				break;
+			}
+			pos = end;
+		}
+		if (insert == 0) {
+			versionLine = 0;
+		}
+
+		std::string block;
+		for (const auto& [name, value] : defines.GetDefines()) {
+			if (!ContainsWord(out, name)) {
+				continue;
+			}
+			block += "#define " + name + " " + value + "\n";
+			if (used) {
+				used->Set(name, value);
+			}
+		}
+		if (!block.empty()) {
+			block += "#line " + std::to_string(versionLine + 1) + "\n";
+			out.insert(insert, block);
+		}
+		return out;
+	}
+
+	const std::string *ShaderPreprocessor::ReadFile(const std::string& path)
+	{
+		auto it = m_files.find(path);
+		if (it != m_files.end()) {
+			return &it->second;
+		}
+
+		std::ifstream file(path, std::ios::binary);
+		if (!file.is_open()) {
+			std::cerr << "Failed to open shader file: " << path << std::endl;
+			return nullptr;
+		}
+
+		std::stringstream buffer;
+		buffer << file.rdbuf();
+		return &(m_files[path] = buffer.str());
+	}
+
+	bool ShaderPreprocessor::Expand(const std::string& path, std::string& out, std::vector<std::string>& stack, std::unordered_set<std::string>& once)
+	{
+		if (std::find(stack.begin(), stack.end(), path) != stack.end()) {
+			std::cerr << "Shader include cycle: " << path << " includes itself" << std::endl;
+			return false;
+		}
+		const std::string *source = ReadFile(path);
+		if (!source) {
+			return false;
+		}
+
+		stack.push_back(path);
+		const std::filesystem::path directory = std::filesystem::path(path).parent_path();
+
+		int lineNumber = 0;
+		for (size_t pos = 0; pos < source->size(); ) {
+			size_t end = source->find('\n', pos);
+			end = end == std::string::npos ? source->size() : end + 1;
+			const std::string line = source->substr(pos, end - pos);
+			pos = end;
+			lineNumber++;
+
+			if (MatchDirective(line, "pragma") && line.find("once") != std::string::npos) {
+				once.insert(path);
+				out += "\n";
+				continue;
+			}
+
+			const char *include = MatchDirective(line, "include");
+			if (!include) {
+				out += line;
+				if (line.empty() || line.back() != '\n') {
+					out += '\n';
+				}
+				continue;
+			}
+
+			const char *open = std::strchr(include, '"');
+			const char *close = open ? std::strchr(open + 1, '"') : nullptr;
+			if (!close) {
+				std::cerr << path << ":" << lineNumber << ": malformed #include" << std::endl;
+				stack.pop_back();
+				return false;
+			}
+
+			const std::string included = (directory / std::string(open + 1, close)).lexically_normal().string();
+			if (once.count(included)) {
+				out += "\n";
+				continue;
+			}
+
+			out += "#line 1\n";
+			if (!Expand(included, out, stack, once)) {
+				std::cerr << "  included from " << path << ":" << lineNumber << std::endl;
+				stack.pop_back();
+				return false;
+			}
+			out += "#line " + std::to_string(lineNumber + 1) + "\n";
+		}
+
+		stack.pop_back();
+		return true;
+	}
+}
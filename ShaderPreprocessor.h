@@ -0,0 +1,43 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include "types.h"
+
+namespace Lumen {
+	// Set of #define name/value pairs. Kept sorted so the same set always gives the same key
+	class ShaderDefines {
+	public:
+		ShaderDefines& Set(const std::string& name, const std::string& value = "1");
+		ShaderDefines& Set(const std::string& name, int value);
+		ShaderDefines& Remove(const std::string& name);
+
+		bool IsEmpty() const { return m_defines.empty(); }
+		// "NAME=VALUE;..." in name order
+		std::string GetKey() const;
+		const std::map<std::string, std::string>& GetDefines() const { return m_defines; }
+	private:
+		std::map<std::string, std::string> m_defines;
+	};
+
+	// Expands #include "file" (relative to the including file, honouring #pragma once) and
+	// injects defines right after #version. Defines whose name never appears in the expanded
+	// source are dropped, so permutations a shader does not care about collapse into one.
+	// #line directives keep compiler messages pointing at the right line of each file.
+	class ShaderPreprocessor {
+	public:
+		// Returns an empty string on failure (missing file, include cycle)
+		std::string Process(const std::string& path, const ShaderDefines& defines, ShaderDefines *used = nullptr);
+
+		// Forgets cached file contents, call after editing shaders on disk
+		void ClearCache() { m_files.clear(); }
+	private:
+		std::unordered_map<std::string, std::string> m_files;
+	private:
+		const std::string *ReadFile(const std::string& path);
+		bool Expand(const std::string& path, std::string& out, std::vector<std::string>& stack, std::unordered_set<std::string>& once);
+	};
+}
@@ -0,0 +1,229 @@
+#include "SpriteBatch.h"
+
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+namespace Lumen {
+	static const char *SpriteVertexShader = R"(#version 410 core
+layout(location = 0) in vec3 a_Position;
+layout(location = 1) in vec2 a_TexCoord;
+layout(location = 2) in vec4 a_Color;
+layout(location = 3) in float a_TextureIndex;
+
+uniform mat4 u_ViewProjection;
+
+out vec2 v_TexCoord;
+out vec4 v_Color;
+flat out int v_TextureIndex;
+
+void main()
+{
+	v_TexCoord = a_TexCoord;
+	v_Color = a_Color;
+	v_TextureIndex = int(a_TextureIndex);
+	gl_Position = u_ViewProjection * vec4(a_Position, 1.0);
+}
+)";
+
+	// GLSL 4.1 only allows constant or uniform sampler array indices, hence the switch
+	static const char *SpriteFragmentShader = R"(#version 410 core
+in vec2 v_TexCoord;
+in vec4 v_Color;
+flat in int v_TextureIndex;
+
+uniform sampler2D u_Textures[8];
+
+out vec4 o_Color;
+
+void main()
+{
+	vec4 texel;
+	switch (v_TextureIndex) {
+		case 0: texel = texture(u_Textures[0], v_TexCoord); break;
+		case 1: texel = texture(u_Textures[1], v_TexCoord); break;
+		case 2: texel = texture(u_Textures[2], v_TexCoord); break;
+		case 3: texel = texture(u_Textures[3], v_TexCoord); break;
+		case 4: texel = texture(u_Textures[4], v_TexCoord); break;
+		case 5: texel = texture(u_Textures[5], v_TexCoord); break;
+		case 6: texel = texture(u_Textures[6], v_TexCoord); break;
+		default: texel = texture(u_Textures[7], v_TexCoord); break;
+	}
+	o_Color = texel * v_Color;
+}
+)";
+
+	SpriteBatch::SpriteBatch(uint maxQuads, uint framesInFlight, uint frameQuads)
+		: m_maxQuads(maxQuads), m_frameQuads(std::max(frameQuads ? frameQuads : maxQuads * 4, maxQuads)),
+		m_framesInFlight(framesInFlight), m_viewProjection(1.0f)
+	{
+		m_vertices.reserve(maxQuads * 4);
+
+		// indices restart at 0 every flush (the base vertex points at the flush's vertices),
+		// so 16 bits cover any batch of up to 16383 quads
+		const bool narrow = maxQuads * 4 <= 0xFFFF;
+		std::vector<uint> pattern(maxQuads * 6);
+		for (uint q = 0; q < maxQuads; q++) {
+			const uint base = q * 4;
+			const uint quad[6] = { base, base + 1, base + 2, base + 2, base + 3, base };
+			std::copy(quad, quad + 6, &pattern[q * 6]);
+		}
+		if (narrow) {
+			std::vector<ushort> shortPattern(pattern.begin(), pattern.end());
+			m_indices = std::make_shared<IndexBuffer>(shortPattern.data(), (uint)(shortPattern.size() * sizeof(ushort)), GL_STATIC_DRAW, GL_UNSIGNED_SHORT);
+		}
+		else {
+			m_indices = std::make_shared<IndexBuffer>(pattern.data(), (uint)(pattern.size() * sizeof(uint)), GL_STATIC_DRAW, GL_UNSIGNED_INT);
+		}
+
+		CreateStream(m_frameQuads);
+
+		const unsigned char white[4] = { 255, 255, 255, 255 };
+		m_white.reset(new Texture(1, 1, white));
+
+		ShaderSource source;
+		source.vertex = SpriteVertexShader;
+		source.fragment = SpriteFragmentShader;
+		m_shader = std::make_shared<Shader>(source);
+		SetupShader();
+	}
+
+	void SpriteBatch::CreateStream(uint frameQuads)
+	{
+		// draws already issued keep the previous buffer alive until the GPU is done with it
+		m_frameQuads = frameQuads;
+		m_stream = std::make_shared<StreamBuffer>(GL_ARRAY_BUFFER, frameQuads * 4 * (uint)sizeof(Vertex), m_framesInFlight);
+
+		VertexBufferLayout layout;
+		layout.Push<float>(3);
+		layout.Push<float>(2);
+		layout.Push<unsigned char>(4);
+		layout.Push<float>(1);
+
+		m_vertexArray = std::make_shared<VertexArray>();
+		m_vertexArray->AddBuffer(m_stream, layout);
+		m_vertexArray->AddIndexBuffer(m_indices);
+	}
+
+	void SpriteBatch::SetShader(const std::shared_ptr<Shader>& shader)
+	{
+		Flush();
+		m_shader = shader;
+		SetupShader();
+	}
+
+	void SpriteBatch::SetupShader()
+	{
+		m_shader->Bind();
+		for (uint i = 0; i < MaxTextures; i++) {
+			m_shader->SetUniform1i("u_Textures[" + std::to_string(i) + "]", (int)i);
+		}
+	}
+
+	void SpriteBatch::Begin(const cx::Mat4& viewProjection)
+	{
+		m_viewProjection = viewProjection;
+		m_vertices.clear();
+		m_textureCount = 0;
+		m_stats = Stats();
+	}
+
+	void SpriteBatch::Begin(const Camera& camera)
+	{
+		Begin(camera.GetViewProjectionMatrix());
+	}
+
+	void SpriteBatch::End()
+	{
+		Flush();
+		m_stream->EndFrame();
+	}
+
+	uint SpriteBatch::GetTextureIndex(const Texture *texture)
+	{
+		if (!texture) {
+			texture = m_white.get();
+		}
+		for (uint i = 0; i < m_textureCount; i++) {
+			if (m_textures[i] == texture) {
+				return i;
+			}
+		}
+		if (m_textureCount == MaxTextures) {
+			Flush();
+		}
+		m_textures[m_textureCount] = texture;
+		return m_textureCount++;
+	}
+
+	void SpriteBatch::DrawQuad(const cx::Vec3& position, const cx::Vec2& size, float rotation, const cx::Vec4& color,
+		const Texture *texture, const cx::Vec4& uvRect)
+	{
+		if (m_vertices.size() + 4 > (size_t)m_maxQuads * 4) {
+			Flush();
+		}
+		const float textureIndex = (float)GetTextureIndex(texture);
+
+		const float c = std::cos(rotation), s = std::sin(rotation);
+		const float hx = size.x() * 0.5f, hy = size.y() * 0.5f;
+		const float corners[4][2] = { { -hx, -hy }, { hx, -hy }, { hx, hy }, { -hx, hy } };
+		const float uvs[4][2] = { { uvRect.x(), uvRect.y() }, { uvRect.z(), uvRect.y() }, { uvRect.z(), uvRect.w() }, { uvRect.x(), uvRect.w() } };
+
+		uchar rgba[4];
+		const float channels[4] = { color.x(), color.y(), color.z(), color.w() };
+		for (uint i = 0; i < 4; i++) {
+			rgba[i] = (uchar)(std::min(std::max(channels[i], 0.0f), 1.0f) * 255.0f + 0.5f);
+		}
+
+		for (uint i = 0; i < 4; i++) {
+			Vertex vertex;
+			vertex.position[0] = position.x() + corners[i][0] * c - corners[i][1] * s;
+			vertex.position[1] = position.y() + corners[i][0] * s + corners[i][1] * c;
+			vertex.position[2] = position.z();
+			vertex.texCoord[0] = uvs[i][0];
+			vertex.texCoord[1] = uvs[i][1];
+			std::memcpy(vertex.color, rgba, 4);
+			vertex.textureIndex = textureIndex;
+			m_vertices.push_back(vertex);
+		}
+		m_stats.sprites++;
+	}
+
+	void SpriteBatch::DrawQuad(const cx::Vec2& position, const cx::Vec2& size, const cx::Vec4& color, const Texture *texture)
+	{
+		DrawQuad(cx::Vec3(position.x(), position.y(), 0.0f), size, 0.0f, color, texture);
+	}
+
+	void SpriteBatch::Flush()
+	{
+		if (m_vertices.empty()) {
+			m_textureCount = 0;
+			return;
+		}
+
+		const uint count = (uint)m_vertices.size();
+		if (m_stream->GetRemaining(sizeof(Vertex)) < count * sizeof(Vertex)) {
+			// the frame outgrew its budget. Moving on to the next section here could wait on a
+			// fence of this very frame, a bigger ring never does
+			std::cerr << "SpriteBatch: more than " << m_frameQuads << " quads this frame, growing the stream buffer" << std::endl;
+			CreateStream(m_frameQuads * 2);
+		}
+		StreamBuffer::Span<Vertex> span = m_stream->Allocate<Vertex>(count, sizeof(Vertex));
+		std::memcpy(span.data, m_vertices.data(), count * sizeof(Vertex));
+		m_stream->Commit();
+
+		m_shader->Bind();
+		m_shader->GetUniform("u_ViewProjection").SetMat4(m_viewProjection);
+		for (uint i = 0; i < m_textureCount; i++) {
+			m_textures[i]->Bind(i);
+		}
+		m_vertexArray->Bind();
+
+		const uint quads = count / 4;
+		Renderer::DrawIndexed(quads * 6, 0, (int)(span.offset / sizeof(Vertex)), GL_TRIANGLES, m_indices->GetType());
+		m_stats.drawCalls++;
+
+		m_vertices.clear();
+		m_textureCount = 0;
+	}
+}
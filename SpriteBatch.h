@@ -0,0 +1,86 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include "types.h"
+#include "Math.h"
+#include "Camera.h"
+#include "Shader.h"
+#include "Textures.h"
+#include "VertexArray.h"
+#include "IndexBuffer.h"
+#include "StreamBuffer.h"
+#include "VertexBufferLayout.h"
+#include "Renderer.h"
+
+namespace Lumen {
+	// Immediate mode 2D quads (HUD, sprites, debug overlays) gathered into one CPU side vertex
+	// array and drawn with a single DrawIndexed per flush. Quads reference up to MaxTextures
+	// different textures per flush, the index pattern is built once and shared by every flush,
+	// and vertices go through a StreamBuffer so the GPU never waits on the upload.
+	// A flush happens on End(), when the batch is full or when a quad needs a texture past
+	// MaxTextures. Every flush of a frame appends to the same StreamBuffer section, sized for
+	// `frameQuads`; a frame that draws more grows the ring instead of waiting on the GPU.
+	// Blend and depth state are left to the caller.
+	class SpriteBatch {
+	public:
+		static const uint MaxTextures = 8;
+
+		struct Stats {
+			uint sprites = 0;
+			uint drawCalls = 0;
+		};
+
+		// `maxQuads` per draw call, `frameQuads` across all flushes of a frame (0 means four
+		// full batches)
+		SpriteBatch(uint maxQuads = 16384, uint framesInFlight = 3, uint frameQuads = 0);
+
+		SpriteBatch(const SpriteBatch&) = delete;
+		SpriteBatch& operator=(const SpriteBatch&) = delete;
+
+		// Once per frame. The camera variant uses its view projection
+		void Begin(const cx::Mat4& viewProjection);
+		void Begin(const Camera& camera);
+		void End();
+
+		// `position` is the quad's center, `rotation` in radians around it, `uvRect` is
+		// (u0, v0, u1, v1). A null texture draws the plain color
+		void DrawQuad(const cx::Vec3& position, const cx::Vec2& size, float rotation, const cx::Vec4& color,
+			const Texture *texture = nullptr, const cx::Vec4& uvRect = cx::Vec4(0.0f, 0.0f, 1.0f, 1.0f));
+		void DrawQuad(const cx::Vec2& position, const cx::Vec2& size, const cx::Vec4& color, const Texture *texture = nullptr);
+
+		void Flush();
+
+		// Replaces the built in shader. It must read the same attributes (position 0,
+		// texcoord 1, color 2, texture index 3) and take u_ViewProjection and u_Textures[MaxTextures]
+		void SetShader(const std::shared_ptr<Shader>& shader);
+
+		const Stats& GetStats() const { return m_stats; }
+	private:
+		struct Vertex {
+			float position[3];
+			float texCoord[2];
+			uchar color[4];
+			float textureIndex;
+		};
+
+		uint m_maxQuads;
+		uint m_frameQuads;
+		uint m_framesInFlight;
+		std::vector<Vertex> m_vertices;
+		std::shared_ptr<StreamBuffer> m_stream;
+		std::shared_ptr<IndexBuffer> m_indices;
+		std::shared_ptr<VertexArray> m_vertexArray;
+		std::shared_ptr<Shader> m_shader;
+		std::unique_ptr<Texture> m_white;
+
+		const Texture *m_textures[MaxTextures];
+		uint m_textureCount = 0;
+		cx::Mat4 m_viewProjection;
+		Stats m_stats;
+	private:
+		void SetupShader();
+		void CreateStream(uint frameQuads);
+		uint GetTextureIndex(const Texture *texture);
+	};
+}
@@ -0,0 +1,129 @@
+#include "StreamBuffer.h"
+
+namespace Lumen {
+	StreamBuffer::StreamBuffer(GLenum target, uint sectionSize, uint sectionCount)
+		: m_id(0), m_target(target), m_sectionSize(sectionSize), m_sectionCount(sectionCount ? sectionCount : 1),
+		m_fences(m_sectionCount, nullptr)
+	{
+		const GLsizeiptr size = (GLsizeiptr)m_sectionSize * m_sectionCount;
+
+		// storage is set up through the copy target, binding an element buffer here would
+		// replace the index buffer of whichever vertex array is bound
+		GLCall(glGenBuffers(1, &m_id));
+		GLState::BindBuffer(GL_COPY_WRITE_BUFFER, m_id);
+
+		if (GLExtensions::HasBufferStorage()) {
+			const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+			GLCall(GLExtensions::BufferStorage(GL_COPY_WRITE_BUFFER, size, nullptr, flags));
+			m_mapped = (unsigned char *)glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, size, flags);
+			if (!m_mapped) {
+				// immutable storage cannot be respecified, the fallback needs a new buffer object
+				GLCall(glDeleteBuffers(1, &m_id));
+				GLState::DeleteBuffer(m_id);
+				GLCall(glGenBuffers(1, &m_id));
+				GLState::BindBuffer(GL_COPY_WRITE_BUFFER, m_id);
+			}
+		}
+		if (!m_mapped) {
+			GLCall(glBufferData(GL_COPY_WRITE_BUFFER, size, nullptr, GL_STREAM_DRAW));
+			m_staging.resize(m_sectionSize);
+		}
+	}
+
+	StreamBuffer::~StreamBuffer()
+	{
+		for (GLsync fence : m_fences) {
+			if (fence) {
+				glDeleteSync(fence);
+			}
+		}
+		if (m_mapped) {
+			GLState::BindBuffer(GL_COPY_WRITE_BUFFER, m_id);
+			GLCall(glUnmapBuffer(GL_COPY_WRITE_BUFFER));
+		}
+		GLCall(glDeleteBuffers(1, &m_id));
+		GLState::DeleteBuffer(m_id);
+	}
+
+	void *StreamBuffer::AllocateBytes(uint size, uint alignment, uint& offset)
+	{
+		if (alignment == 0) {
+			alignment = 1;
+		}
+		const uint start = (m_head + alignment - 1) / alignment * alignment;
+		if (start + size > m_sectionSize) {
+			std::cerr << "StreamBuffer: section of " << m_sectionSize << " bytes is full" << std::endl;
+			return nullptr;
+		}
+
+		m_head = start + size;
+		offset = m_section * m_sectionSize + start;
+		return m_mapped ? m_mapped + offset : m_staging.data() + start;
+	}
+
+	uint StreamBuffer::GetRemaining(uint alignment) const
+	{
+		if (alignment == 0) {
+			alignment = 1;
+		}
+		const uint start = (m_head + alignment - 1) / alignment * alignment;
+		return start < m_sectionSize ? m_sectionSize - start : 0;
+	}
+
+	void StreamBuffer::Commit()
+	{
+		if (m_mapped || m_head == m_committed) {
+			return;
+		}
+
+		GLState::BindBuffer(GL_COPY_WRITE_BUFFER, m_id);
+		GLCall(glBufferSubData(GL_COPY_WRITE_BUFFER, m_section * m_sectionSize + m_committed, m_head - m_committed, m_staging.data() + m_committed));
+		m_committed = m_head;
+	}
+
+	void StreamBuffer::EndFrame()
+	{
+		Commit();
+
+		if (m_fences[m_section]) {
+			glDeleteSync(m_fences[m_section]);
+		}
+		m_fences[m_section] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+		m_section = (m_section + 1) % m_sectionCount;
+		m_head = 0;
+		m_committed = 0;
+		WaitForSection(m_section);
+	}
+
+	void StreamBuffer::WaitForSection(uint section)
+	{
+		GLsync fence = m_fences[section];
+		if (!fence) {
+			return;
+		}
+
+		// the first wait flushes so the fence is guaranteed to signal eventually
+		GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+		for (;;) {
+			const GLenum result = glClientWaitSync(fence, flags, 1000000);
+			if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED || result == GL_WAIT_FAILED) {
+				break;
+			}
+			flags = 0;
+		}
+
+		glDeleteSync(fence);
+		m_fences[section] = nullptr;
+	}
+
+	void StreamBuffer::Bind() const
+	{
+		GLState::BindBuffer(m_target, m_id);
+	}
+
+	void StreamBuffer::Unbind() const
+	{
+		GLState::BindBuffer(m_target, 0);
+	}
+}
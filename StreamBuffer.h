@@ -0,0 +1,76 @@
+#pragma once
+
+#include <vector>
+#include <glad/glad.h>
+#include "types.h"
+#include "Utils.h"
+#include "GLState.h"
+#include "GLExtensions.h"
+
+namespace Lumen {
+	// Ring of `sectionCount` equally sized sections in one buffer object, one section per
+	// frame in flight. With buffer storage the whole ring is mapped persistent + coherent and
+	// writes go straight into GPU visible memory; otherwise they are staged and uploaded by Commit().
+	// A fence guards every section, EndFrame() only blocks if the GPU is still reading the next one.
+	class StreamBuffer {
+	public:
+		template<typename T>
+		struct Span {
+			T *data = nullptr;
+			uint count = 0;
+			uint offset = 0;	// byte offset into the buffer object, what draw calls read from
+
+			explicit operator bool() const { return data != nullptr; }
+			T& operator[](uint i) const { return data[i]; }
+			T *begin() const { return data; }
+			T *end() const { return data + count; }
+		};
+
+		StreamBuffer(GLenum target, uint sectionSize, uint sectionCount = 3);
+		~StreamBuffer();
+
+		StreamBuffer(const StreamBuffer&) = delete;
+		StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+		// Reserves room for `count` elements in the current section; empty span when it is full
+		template<typename T>
+		Span<T> Allocate(uint count, uint alignment = alignof(T))
+		{
+			Span<T> span;
+			void *data = AllocateBytes(count * sizeof(T), alignment, span.offset);
+			if (data) {
+				span.data = static_cast<T *>(data);
+				span.count = count;
+			}
+			return span;
+		}
+		void *AllocateBytes(uint size, uint alignment, uint& offset);
+		// Bytes an allocation aligned to `alignment` could still get from the current section
+		uint GetRemaining(uint alignment = 1) const;
+
+		// Makes everything allocated so far visible to the GPU. No-op for persistent mappings
+		void Commit();
+		// Fences the current section and moves on to the next one
+		void EndFrame();
+
+		void Bind() const;
+		void Unbind() const;
+		uint GetID() const { return m_id; }
+		GLenum GetTarget() const { return m_target; }
+		uint GetSectionSize() const { return m_sectionSize; }
+		bool IsPersistent() const { return m_mapped != nullptr; }
+	private:
+		uint m_id;
+		GLenum m_target;
+		uint m_sectionSize;
+		uint m_sectionCount;
+		uint m_section = 0;
+		uint m_head = 0;		// write position inside the current section
+		uint m_committed = 0;	// staged bytes already uploaded in the current section
+		unsigned char *m_mapped = nullptr;
+		std::vector<unsigned char> m_staging;
+		std::vector<GLsync> m_fences;
+	private:
+		void WaitForSection(uint section);
+	};
+}
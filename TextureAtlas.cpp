@@ -0,0 +1,178 @@
+#include "TextureAtlas.h"
+
+#include <cstring>
+#include <numeric>
+#include <algorithm>
+
+namespace Lumen {
+	TextureAtlas::TextureAtlas(uint pageSize, uint padding)
+		: m_pageSize(pageSize), m_padding(padding)
+	{
+	}
+
+	TextureAtlas::~TextureAtlas()
+	{
+		if (m_id) {
+			GLCall(glDeleteTextures(1, &m_id));
+			GLState::DeleteTexture(m_id);
+		}
+	}
+
+	uint TextureAtlas::Add(const TextureData& image)
+	{
+		if (m_built) {
+			// the images behind the old regions are gone, they cannot be packed again
+			m_regions.clear();
+			m_built = false;
+		}
+
+		if (image.IsCompressed() || !image.HasBytes() || image.levels.empty()) {
+			std::cerr << "TextureAtlas: only uncompressed RGBA8 images can be packed" << std::endl;
+			m_images.push_back(TextureData::FromRGBA(0, 0, nullptr));
+		}
+		else {
+			const TextureLevel& level = image.levels[0];
+			m_images.push_back(TextureData::FromRGBA(level.width, level.height, image.GetBytes() + level.offset));
+		}
+		m_regions.push_back(AtlasRegion());
+		return (uint)m_regions.size() - 1;
+	}
+
+	uint TextureAtlas::Add(const Texture& texture)
+	{
+		// compressed textures are decompressed by the driver on the way out
+		std::vector<unsigned char> pixels((size_t)texture.GetWidth() * texture.GetHeight() * 4);
+		GLState::BindTexture(GL_TEXTURE_2D, texture.GetID());
+		GLCall(glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data()));
+		return Add(TextureData::FromRGBA(texture.GetWidth(), texture.GetHeight(), pixels.data()));
+	}
+
+	bool TextureAtlas::Build(bool asArray, bool generateMips)
+	{
+		if (m_built) {
+			// nothing added since the last build
+			return true;
+		}
+
+		std::vector<uint> order(m_images.size());
+		std::iota(order.begin(), order.end(), 0);
+		std::stable_sort(order.begin(), order.end(), [this](uint a, uint b) {
+			return m_images[a].GetHeight() > m_images[b].GetHeight();
+		});
+
+		std::vector<RectPacker> pages;
+		for (uint index : order) {
+			const TextureData& image = m_images[index];
+			const uint width = image.GetWidth() + m_padding * 2;
+			const uint height = image.GetHeight() + m_padding * 2;
+			if (width > m_pageSize || height > m_pageSize) {
+				std::cerr << "TextureAtlas: " << image.GetWidth() << "x" << image.GetHeight() << " image does not fit a " << m_pageSize << " page" << std::endl;
+				return false;
+			}
+
+			uint x = 0, y = 0;
+			uint page = 0;
+			while (page < pages.size() && !pages[page].Insert(width, height, x, y)) {
+				page++;
+			}
+			if (page == pages.size()) {
+				if (!asArray && !pages.empty()) {
+					std::cerr << "TextureAtlas: images do not fit a single " << m_pageSize << " page, build it as an array" << std::endl;
+					return false;
+				}
+				pages.emplace_back(m_pageSize, m_pageSize);
+				pages.back().Insert(width, height, x, y);
+			}
+
+			AtlasRegion& region = m_regions[index];
+			region.layer = page;
+			region.x = x + m_padding;
+			region.y = y + m_padding;
+			region.width = image.GetWidth();
+			region.height = image.GetHeight();
+			region.offsetU = (float)region.x / m_pageSize;
+			region.offsetV = (float)region.y / m_pageSize;
+			region.scaleU = (float)region.width / m_pageSize;
+			region.scaleV = (float)region.height / m_pageSize;
+		}
+		m_pageCount = std::max((uint)pages.size(), 1u);
+
+		std::vector<TextureData> pageData(m_pageCount);
+		for (TextureData& page : pageData) {
+			page = TextureData::FromRGBA(m_pageSize, m_pageSize, nullptr);
+			page.bytes.assign((size_t)m_pageSize * m_pageSize * 4, 0);
+		}
+		for (size_t i = 0; i < m_images.size(); i++) {
+			Blit(m_images[i], m_regions[i], pageData[m_regions[i].layer]);
+		}
+		if (generateMips) {
+			for (TextureData& page : pageData) {
+				page.GenerateMips();
+			}
+		}
+		m_images.clear();
+		m_built = true;
+
+		if (m_id) {
+			GLCall(glDeleteTextures(1, &m_id));
+			GLState::DeleteTexture(m_id);
+		}
+		m_target = asArray ? GL_TEXTURE_2D_ARRAY : GL_TEXTURE_2D;
+		const uint levelCount = (uint)pageData[0].levels.size();
+
+		GLCall(glGenTextures(1, &m_id));
+		GLState::BindTexture(m_target, m_id);
+		GLCall(glTexParameteri(m_target, GL_TEXTURE_MIN_FILTER, levelCount > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR));
+		GLCall(glTexParameteri(m_target, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+		GLCall(glTexParameteri(m_target, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+		GLCall(glTexParameteri(m_target, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+		GLCall(glTexParameteri(m_target, GL_TEXTURE_MAX_LEVEL, levelCount - 1));
+
+		for (uint level = 0; level < levelCount; level++) {
+			const TextureLevel& info = pageData[0].levels[level];
+			if (!asArray) {
+				GLCall(glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA8, info.width, info.height, 0, GL_RGBA, GL_UNSIGNED_BYTE,
+					pageData[0].GetBytes() + info.offset));
+				continue;
+			}
+
+			GLCall(glTexImage3D(GL_TEXTURE_2D_ARRAY, level, GL_RGBA8, info.width, info.height, m_pageCount, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr));
+			for (uint layer = 0; layer < m_pageCount; layer++) {
+				GLCall(glTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, layer, info.width, info.height, 1, GL_RGBA, GL_UNSIGNED_BYTE,
+					pageData[layer].GetBytes() + info.offset));
+			}
+		}
+		GLState::BindTexture(m_target, 0);
+		return true;
+	}
+
+	void TextureAtlas::Blit(const TextureData& image, const AtlasRegion& region, TextureData& page) const
+	{
+		if (region.width == 0 || region.height == 0) {
+			return;
+		}
+
+		const unsigned char *src = image.GetBytes();
+		unsigned char *dst = page.bytes.data();
+		const int padding = (int)m_padding;
+		for (int y = -padding; y < (int)region.height + padding; y++) {
+			// padding repeats the outermost texels so bilinear and mip filtering stay inside
+			const int sy = std::clamp(y, 0, (int)region.height - 1);
+			unsigned char *row = dst + ((size_t)(region.y + y) * m_pageSize + region.x) * 4;
+			for (int x = -padding; x < (int)region.width + padding; x++) {
+				const int sx = std::clamp(x, 0, (int)region.width - 1);
+				std::memcpy(row + x * 4, src + ((size_t)sy * region.width + sx) * 4, 4);
+			}
+		}
+	}
+
+	void TextureAtlas::Bind(uint slot) const
+	{
+		GLState::BindTexture(m_target, slot, m_id);
+	}
+
+	void TextureAtlas::Unbind() const
+	{
+		GLState::BindTexture(m_target, 0);
+	}
+}
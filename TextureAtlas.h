@@ -0,0 +1,66 @@
+#pragma once
+
+#include <vector>
+#include <glad/glad.h>
+#include "types.h"
+#include "Utils.h"
+#include "GLState.h"
+#include "RectPacker.h"
+#include "TextureData.h"
+#include "Textures.h"
+
+namespace Lumen {
+	// Where an image ended up: sample it at (offset + uv * scale) in `layer`.
+	// For a single page atlas layer is always 0
+	struct AtlasRegion {
+		float offsetU = 0.0f, offsetV = 0.0f;
+		float scaleU = 0.0f, scaleV = 0.0f;
+		uint layer = 0;
+		uint x = 0, y = 0, width = 0, height = 0;	// in texels
+	};
+
+	// Packs many RGBA8 images into equally sized pages and uploads them either as one
+	// GL_TEXTURE_2D (everything must fit a single page) or as the layers of a
+	// GL_TEXTURE_2D_ARRAY, so materials sharing the atlas need one bind between them.
+	// Every image gets `padding` texels of its own edge around it against filtering bleed.
+	class TextureAtlas {
+	public:
+		TextureAtlas(uint pageSize = 2048, uint padding = 2);
+		~TextureAtlas();
+
+		TextureAtlas(const TextureAtlas&) = delete;
+		TextureAtlas& operator=(const TextureAtlas&) = delete;
+
+		// Returns the region index. Only level 0 is used, compressed data is not accepted.
+		// The first Add() after a Build() starts a new atlas: the regions of the previous one
+		// are dropped, indices restart at 0 and the next Build() replaces the texture
+		uint Add(const TextureData& image);
+		// Reads the texture back from GL, so prefer the TextureData overload at load time
+		uint Add(const Texture& texture);
+
+		// Packs everything added (tallest first), then creates the GL texture.
+		// Returns false if an image is bigger than a page or a 2D atlas overflows its page
+		bool Build(bool asArray = true, bool generateMips = true);
+
+		const AtlasRegion& GetRegion(uint index) const { return m_regions[index]; }
+		uint GetRegionCount() const { return (uint)m_regions.size(); }
+		uint GetPageCount() const { return m_pageCount; }
+		uint GetPageSize() const { return m_pageSize; }
+
+		void Bind(uint slot = 0) const;
+		void Unbind() const;
+		uint GetID() const { return m_id; }
+		GLenum GetTarget() const { return m_target; }
+	private:
+		uint m_id = 0;
+		GLenum m_target = GL_TEXTURE_2D_ARRAY;
+		uint m_pageSize;
+		uint m_padding;
+		uint m_pageCount = 0;
+		std::vector<TextureData> m_images;		// dropped after Build
+		std::vector<AtlasRegion> m_regions;		// m_regions[i] belongs to m_images[i] until Build
+		bool m_built = false;
+	private:
+		void Blit(const TextureData& image, const AtlasRegion& region, TextureData& page) const;
+	};
+}
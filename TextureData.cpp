@@ -0,0 +1,328 @@
+#include "TextureData.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include "external/stb_image.h"
+
+namespace Lumen {
+	namespace {
+		bool ReadFile(const std::string& path, std::vector<unsigned char>& out)
+		{
+			std::ifstream file(path, std::ios::binary | std::ios::ate);
+			if (!file.is_open()) {
+				std::cerr << "Failed to open texture file: " << path << std::endl;
+				return false;
+			}
+			out.resize((size_t)file.tellg());
+			file.seekg(0);
+			file.read((char *)out.data(), out.size());
+			return (bool)file;
+		}
+
+		template<typename T>
+		T Read(const std::vector<unsigned char>& file, size_t offset)
+		{
+			T value;
+			std::memcpy(&value, file.data() + offset, sizeof(T));
+			return value;
+		}
+
+		bool EndsWith(const std::string& s, const char *suffix)
+		{
+			const size_t length = std::strlen(suffix);
+			if (s.size() < length) {
+				return false;
+			}
+			for (size_t i = 0; i < length; i++) {
+				const char c = s[s.size() - length + i];
+				if ((c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c) != suffix[i]) {
+					return false;
+				}
+			}
+			return true;
+		}
+
+		uint FourCC(const char *code)
+		{
+			return (uint)code[0] | ((uint)code[1] << 8) | ((uint)code[2] << 16) | ((uint)code[3] << 24);
+		}
+
+		GLenum FromDXGIFormat(uint format)
+		{
+			switch (format) {
+				case 28:	return GL_RGBA8;								// R8G8B8A8_UNORM
+				case 71:	return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;		// BC1_UNORM
+				case 72:	return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT;	// BC1_UNORM_SRGB
+				case 77:	return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;		// BC3_UNORM
+				case 78:	return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT;	// BC3_UNORM_SRGB
+				case 98:	return GL_COMPRESSED_RGBA_BPTC_UNORM;			// BC7_UNORM
+				case 99:	return GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM;		// BC7_UNORM_SRGB
+			}
+			return 0;
+		}
+
+		GLenum FromVkFormat(uint format)
+		{
+			switch (format) {
+				case 37:	return GL_RGBA8;								// R8G8B8A8_UNORM
+				case 131:	return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;			// BC1_RGB_UNORM_BLOCK
+				case 132:	return GL_COMPRESSED_SRGB_S3TC_DXT1_EXT;		// BC1_RGB_SRGB_BLOCK
+				case 133:	return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;		// BC1_RGBA_UNORM_BLOCK
+				case 134:	return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT;	// BC1_RGBA_SRGB_BLOCK
+				case 137:	return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;		// BC3_UNORM_BLOCK
+				case 138:	return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT;	// BC3_SRGB_BLOCK
+				case 145:	return GL_COMPRESSED_RGBA_BPTC_UNORM;			// BC7_UNORM_BLOCK
+				case 146:	return GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM;		// BC7_SRGB_BLOCK
+			}
+			return 0;
+		}
+	}
+
+	bool TextureData::Load(const std::string& path, bool generateMips)
+	{
+		if (EndsWith(path, ".dds")) {
+			return LoadDDS(path);
+		}
+		if (EndsWith(path, ".ktx2")) {
+			return LoadKTX2(path);
+		}
+		return LoadStbImage(path, generateMips);
+	}
+
+	bool TextureData::LoadStbImage(const std::string& path, bool generateMips)
+	{
+		int width = 0, height = 0, channels = 0;
+		stbi_set_flip_vertically_on_load_thread(1);
+		unsigned char *pixels = stbi_load(path.c_str(), &width, &height, &channels, 4);
+		if (!pixels) {
+			std::cerr << "Failed to load texture: " << path << " (" << stbi_failure_reason() << ")" << std::endl;
+			return false;
+		}
+
+		*this = FromRGBA(width, height, pixels);
+		stbi_image_free(pixels);
+
+		if (generateMips) {
+			GenerateMips();
+		}
+		return true;
+	}
+
+	bool TextureData::LoadDDS(const std::string& path)
+	{
+		std::vector<unsigned char> file;
+		if (!ReadFile(path, file)) {
+			return false;
+		}
+		if (file.size() < 128 || Read<uint>(file, 0) != FourCC("DDS ")) {
+			std::cerr << path << ": not a DDS file" << std::endl;
+			return false;
+		}
+
+		// DDS_HEADER follows the magic, DDS_PIXELFORMAT sits at byte 76 of the file
+		const uint height = Read<uint>(file, 12);
+		const uint width = Read<uint>(file, 16);
+		const uint flags = Read<uint>(file, 8);
+		const uint mipCount = (flags & 0x20000) ? std::max(Read<uint>(file, 28), 1u) : 1;
+		const uint fourCC = Read<uint>(file, 84);
+		const uint caps2 = Read<uint>(file, 112);
+		size_t offset = 128;
+
+		GLenum glFormat = 0;
+		if (fourCC == FourCC("DXT1")) {
+			glFormat = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+		}
+		else if (fourCC == FourCC("DXT5")) {
+			glFormat = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+		}
+		else if (fourCC == FourCC("DX10") && file.size() >= 148) {
+			glFormat = FromDXGIFormat(Read<uint>(file, 128));
+			offset = 148;
+		}
+		if (!glFormat) {
+			std::cerr << path << ": unsupported DDS pixel format" << std::endl;
+			return false;
+		}
+		if (caps2 & 0x200) {
+			std::cerr << path << ": DDS cube maps are not supported" << std::endl;
+			return false;
+		}
+
+		format = glFormat;
+		levels.clear();
+		bytes.clear();
+		uint w = width, h = height;
+		for (uint i = 0; i < mipCount; i++) {
+			levels.push_back({ w, h, bytes.size(), 0 });
+			const size_t size = GetRowPitch(i) * GetRowCount(i);
+			if (offset + size > file.size()) {
+				std::cerr << path << ": truncated DDS file" << std::endl;
+				return false;
+			}
+			levels[i].size = size;
+			bytes.insert(bytes.end(), file.begin() + offset, file.begin() + offset + size);
+			offset += size;
+			w = std::max(w / 2, 1u);
+			h = std::max(h / 2, 1u);
+		}
+		return true;
+	}
+
+	bool TextureData::LoadKTX2(const std::string& path)
+	{
+		static const unsigned char identifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+		std::vector<unsigned char> file;
+		if (!ReadFile(path, file)) {
+			return false;
+		}
+		if (file.size() < 80 || std::memcmp(file.data(), identifier, sizeof(identifier)) != 0) {
+			std::cerr << path << ": not a KTX2 file" << std::endl;
+			return false;
+		}
+
+		const uint vkFormat = Read<uint>(file, 12);
+		const uint width = Read<uint>(file, 20);
+		const uint height = std::max(Read<uint>(file, 24), 1u);
+		const uint depth = Read<uint>(file, 28);
+		const uint layerCount = Read<uint>(file, 32);
+		const uint faceCount = Read<uint>(file, 36);
+		const uint levelCount = std::max(Read<uint>(file, 40), 1u);
+		const uint supercompression = Read<uint>(file, 44);
+
+		const GLenum glFormat = FromVkFormat(vkFormat);
+		if (!glFormat) {
+			std::cerr << path << ": unsupported KTX2 format " << vkFormat << std::endl;
+			return false;
+		}
+		if (supercompression != 0) {
+			std::cerr << path << ": supercompressed KTX2 (Basis, zstd) is not supported" << std::endl;
+			return false;
+		}
+		if (depth > 1 || layerCount > 1 || faceCount != 1) {
+			std::cerr << path << ": only plain 2D KTX2 textures are supported" << std::endl;
+			return false;
+		}
+		if (width == 0 || width > MaxDimension || height > MaxDimension) {
+			std::cerr << path << ": invalid KTX2 size " << width << "x" << height << std::endl;
+			return false;
+		}
+		if (file.size() < 80 + (size_t)levelCount * 24) {
+			std::cerr << path << ": truncated KTX2 file" << std::endl;
+			return false;
+		}
+
+		format = glFormat;
+		levels.clear();
+		bytes.clear();
+		uint w = width, h = height;
+		for (uint i = 0; i < levelCount; i++) {
+			// level index: byteOffset, byteLength, uncompressedByteLength as 64 bit values
+			const uint64_t levelOffset = Read<uint64_t>(file, 80 + i * 24);
+			const uint64_t levelLength = Read<uint64_t>(file, 80 + i * 24 + 8);
+			if (levelOffset > file.size() || levelLength > file.size() - levelOffset) {
+				std::cerr << path << ": truncated KTX2 file" << std::endl;
+				return false;
+			}
+
+			// uploads read exactly this much, a level of any other size cannot be used
+			levels.push_back({ w, h, bytes.size(), 0 });
+			const size_t size = GetRowPitch(i) * GetRowCount(i);
+			if (levelLength != size) {
+				std::cerr << path << ": KTX2 level " << i << " holds " << levelLength << " bytes, " << w << "x" << h << " needs " << size << std::endl;
+				return false;
+			}
+			levels[i].size = size;
+			bytes.insert(bytes.end(), file.begin() + levelOffset, file.begin() + levelOffset + levelLength);
+			w = std::max(w / 2, 1u);
+			h = std::max(h / 2, 1u);
+		}
+		return true;
+	}
+
+	TextureData TextureData::FromRGBA(uint width, uint height, const unsigned char *pixels)
+	{
+		TextureData data;
+		data.format = GL_RGBA8;
+		if (pixels) {
+			data.bytes.assign(pixels, pixels + (size_t)width * height * 4);
+		}
+		data.levels.push_back({ width, height, 0, (size_t)width * height * 4 });
+		return data;
+	}
+
+	void TextureData::GenerateMips()
+	{
+		if (IsCompressed() || levels.empty() || bytes.empty() || m_external) {
+			return;
+		}
+		levels.resize(1);
+		bytes.resize(levels[0].size);
+
+		while (levels.back().width > 1 || levels.back().height > 1) {
+			const TextureLevel source = levels.back();
+			const uint width = std::max(source.width / 2, 1u);
+			const uint height = std::max(source.height / 2, 1u);
+			AddLevel(width, height, (size_t)width * height * 4);
+
+			const unsigned char *src = bytes.data() + source.offset;
+			unsigned char *dst = bytes.data() + levels.back().offset;
+			for (uint y = 0; y < height; y++) {
+				// odd sizes clamp, the last row / column is averaged with itself
+				const uint y0 = std::min(y * 2, source.height - 1);
+				const uint y1 = std::min(y * 2 + 1, source.height - 1);
+				for (uint x = 0; x < width; x++) {
+					const uint x0 = std::min(x * 2, source.width - 1);
+					const uint x1 = std::min(x * 2 + 1, source.width - 1);
+					const unsigned char *a = src + ((size_t)y0 * source.width + x0) * 4;
+					const unsigned char *b = src + ((size_t)y0 * source.width + x1) * 4;
+					const unsigned char *c = src + ((size_t)y1 * source.width + x0) * 4;
+					const unsigned char *d = src + ((size_t)y1 * source.width + x1) * 4;
+					for (uint i = 0; i < 4; i++) {
+						dst[i] = (unsigned char)((a[i] + b[i] + c[i] + d[i] + 2) / 4);
+					}
+					dst += 4;
+				}
+			}
+		}
+	}
+
+	size_t TextureData::GetRowPitch(uint level) const
+	{
+		const uint blockSize = GetBlockSize(format);
+		if (blockSize) {
+			return (size_t)((levels[level].width + 3) / 4) * blockSize;
+		}
+		return (size_t)levels[level].width * 4;
+	}
+
+	uint TextureData::GetRowCount(uint level) const
+	{
+		return IsCompressed() ? (levels[level].height + 3) / 4 : levels[level].height;
+	}
+
+	uint TextureData::GetBlockSize(GLenum format)
+	{
+		switch (format) {
+			case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+			case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+			case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:
+			case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT:
+				return 8;
+			case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+			case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:
+			case GL_COMPRESSED_RGBA_BPTC_UNORM:
+			case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM:
+				return 16;
+		}
+		return 0;
+	}
+
+	void TextureData::AddLevel(uint width, uint height, size_t size)
+	{
+		levels.push_back({ width, height, bytes.size(), size });
+		bytes.resize(bytes.size() + size);
+	}
+}
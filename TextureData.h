@@ -0,0 +1,65 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <glad/glad.h>
+#include "types.h"
+#include "GLExtensions.h"
+
+namespace Lumen {
+	struct TextureLevel {
+		uint width;
+		uint height;
+		size_t offset;	// into TextureData::bytes
+		size_t size;
+	};
+
+	// CPU side image with its full mip chain, either RGBA8 or a block compressed format
+	// (BC1, BC3, BC7) ready for glCompressedTexImage2D.
+	// Images decoded through stb_image are flipped to GL's bottom-up row order; DDS and KTX2
+	// payloads are uploaded as stored, since block compressed data cannot be flipped in
+	// general, so author those files bottom-up or flip the texture coordinates.
+	class TextureData {
+	public:
+		// Above what any GL implementation accepts; keeps level sizes of untrusted headers
+		// far from overflowing
+		static const uint MaxDimension = 1 << 16;
+
+		GLenum format = GL_RGBA8;	// GL internal format
+		std::vector<TextureLevel> levels;
+		std::vector<unsigned char> bytes;
+
+		// Picks the container from the extension: .dds, .ktx2, anything else through stb_image.
+		// Mips are generated only for decoded images, containers bring their own
+		bool Load(const std::string& path, bool generateMips = true);
+		bool LoadStbImage(const std::string& path, bool generateMips = true);
+		bool LoadDDS(const std::string& path);
+		bool LoadKTX2(const std::string& path);
+
+		static TextureData FromRGBA(uint width, uint height, const unsigned char *pixels);
+
+		// Appends 2x2 box filtered levels down to 1x1. RGBA8 only
+		void GenerateMips();
+
+		bool IsCompressed() const { return GetBlockSize(format) != 0; }
+		uint GetWidth() const { return levels.empty() ? 0 : levels[0].width; }
+		uint GetHeight() const { return levels.empty() ? 0 : levels[0].height; }
+		// Bytes per row of pixels, or per row of 4x4 blocks for compressed formats
+		size_t GetRowPitch(uint level) const;
+		uint GetRowCount(uint level) const;
+		uint GetRowHeight() const { return IsCompressed() ? 4 : 1; }
+
+		// Level offsets index into the owned `bytes`, or into memory handed to SetExternal(),
+		// which must outlive this and is never copied (AssetPack points it into its mapping)
+		const unsigned char *GetBytes() const { return m_external ? m_external : bytes.data(); }
+		bool HasBytes() const { return m_external || !bytes.empty(); }
+		void SetExternal(const unsigned char *data) { m_external = data; }
+
+		// Bytes per 4x4 block, 0 for uncompressed formats
+		static uint GetBlockSize(GLenum format);
+	private:
+		const unsigned char *m_external = nullptr;
+	private:
+		void AddLevel(uint width, uint height, size_t size);
+	};
+}
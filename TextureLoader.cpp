@@ -0,0 +1,187 @@
+#include "TextureLoader.h"
+
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+
+namespace Lumen {
+	TextureLoader::TextureLoader(JobSystem& jobs, uint decodeJobs, uint uploadBudget, bool generateMips)
+		: m_jobs(jobs), m_decodeJobs(decodeJobs ? decodeJobs : 1), m_uploadBudget(uploadBudget), m_generateMips(generateMips),
+		m_staging(GL_PIXEL_UNPACK_BUFFER, uploadBudget)
+	{
+		// StreamBuffer sets up and fills its storage through GL_COPY_WRITE_BUFFER. The unpack
+		// binding is only held around the uploads in Upload(), every other glTex*Image call
+		// passes client memory and must find GL_PIXEL_UNPACK_BUFFER unbound
+		m_staging.Unbind();
+	}
+
+	TextureLoader::~TextureLoader()
+	{
+		// images being decoded finish, requests that never started are dropped
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_stopping = true;
+		}
+		m_jobs.Wait(m_decodeCounter);
+	}
+
+	std::shared_ptr<Texture> TextureLoader::Load(const std::string& path)
+	{
+		auto it = m_textures.find(path);
+		if (it != m_textures.end()) {
+			if (std::shared_ptr<Texture> texture = it->second.lock()) {
+				return texture;
+			}
+		}
+
+		static const unsigned char placeholder[4] = { 128, 128, 128, 255 };
+		std::shared_ptr<Texture> texture = std::make_shared<Texture>(1, 1, placeholder);
+		texture->m_filePath = path;
+		m_textures[path] = texture;
+		m_stats.requested++;
+
+		bool start = false;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_requests.push_back({ path, texture });
+			m_decoding++;
+			if (m_decoders < m_decodeJobs) {
+				m_decoders++;
+				start = true;
+			}
+		}
+		if (start) {
+			m_jobs.RunBackground([this]() { Decode(); }, &m_decodeCounter);
+		}
+		return texture;
+	}
+
+	void TextureLoader::Decode()
+	{
+		for (;;) {
+			Request request;
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				if (m_stopping || m_requests.empty()) {
+					m_decoders--;
+					return;
+				}
+				request = std::move(m_requests.front());
+				m_requests.pop_front();
+			}
+
+			Job job;
+			job.texture = request.texture;
+			job.loaded = job.data.Load(request.path, m_generateMips);
+
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_decoding--;
+			m_decoded.push_back(std::move(job));
+		}
+	}
+
+	void TextureLoader::Update()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			while (!m_decoded.empty()) {
+				m_uploading.push_back(std::move(m_decoded.front()));
+				m_decoded.pop_front();
+			}
+		}
+
+		m_stats.bytesUploaded = 0;
+		uint budget = m_uploadBudget;
+		while (!m_uploading.empty()) {
+			Job& job = m_uploading.front();
+			if (!job.loaded) {
+				m_stats.failed++;
+				m_uploading.pop_front();
+				continue;
+			}
+			if (!Upload(job, budget)) {
+				break;
+			}
+
+			m_stats.completed++;
+			m_uploading.pop_front();
+		}
+
+		if (m_stats.bytesUploaded > 0) {
+			m_staging.EndFrame();
+		}
+	}
+
+	bool TextureLoader::Upload(Job& job, uint& budget)
+	{
+		std::shared_ptr<Texture> texture = job.texture.lock();
+		if (!texture) {
+			// nobody holds it anymore
+			return true;
+		}
+
+		const TextureData& data = job.data;
+		if (!job.allocated) {
+			job.allocated = true;
+			if (!texture->Allocate(data, false)) {
+				// keeps the placeholder, Allocate already reported why
+				return true;
+			}
+		}
+
+		while (job.level < data.levels.size()) {
+			const TextureLevel& level = data.levels[job.level];
+			const uint rowPitch = (uint)data.GetRowPitch(job.level);
+			const uint rowCount = data.GetRowCount(job.level);
+			const uint rowHeight = data.GetRowHeight();
+
+			uint rows = rowCount - job.uploadedRows;
+			const unsigned char *source = data.GetBytes() + level.offset + (size_t)job.uploadedRows * rowPitch;
+			const void *pixels = source;
+			if (rowPitch <= m_uploadBudget) {
+				rows = std::min(rows, budget / rowPitch);
+				if (rows == 0) {
+					return false;
+				}
+
+				StreamBuffer::Span<unsigned char> span = m_staging.Allocate<unsigned char>(rows * rowPitch, 4);
+				if (!span) {
+					return false;
+				}
+				std::memcpy(span.data, source, rows * rowPitch);
+				m_staging.Commit();
+				// with the unpack buffer bound the pointer argument is an offset into it
+				m_staging.Bind();
+				pixels = (const void *)(uintptr_t)span.offset;
+			}
+			// else a single row does not fit a staging section, upload straight from memory
+
+			const uint y = job.uploadedRows * rowHeight;
+			const uint height = std::min(rows * rowHeight, level.height - y);
+			GLState::BindTexture(GL_TEXTURE_2D, texture->GetID());
+			if (data.IsCompressed()) {
+				GLCall(glCompressedTexSubImage2D(GL_TEXTURE_2D, job.level, 0, y, level.width, height, data.format, rows * rowPitch, pixels));
+			}
+			else {
+				GLCall(glTexSubImage2D(GL_TEXTURE_2D, job.level, 0, y, level.width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels));
+			}
+			m_staging.Unbind();
+
+			const uint bytes = rows * rowPitch;
+			budget = bytes < budget ? budget - bytes : 0;
+			m_stats.bytesUploaded += bytes;
+			job.uploadedRows += rows;
+			if (job.uploadedRows == rowCount) {
+				job.level++;
+				job.uploadedRows = 0;
+			}
+		}
+		return true;
+	}
+
+	uint TextureLoader::GetPendingCount() const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_decoding + (uint)(m_decoded.size() + m_uploading.size());
+	}
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <deque>
+#include <mutex>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include "types.h"
+#include "Textures.h"
+#include "JobSystem.h"
+#include "StreamBuffer.h"
+
+namespace Lumen {
+	// Loads images and their mip chains (see TextureData) as background jobs and uploads them
+	// from the render thread through a pixel unpack StreamBuffer. Load() returns a 1x1 placeholder at once; the same Texture
+	// object receives the real image later, so whoever holds it needs no notification.
+	// Update() uploads at most `uploadBudget` bytes per call, big images go up in row strips
+	// over several frames, one level after another.
+	class TextureLoader {
+	public:
+		struct Stats {
+			uint requested = 0;
+			uint completed = 0;
+			uint failed = 0;
+			size_t bytesUploaded = 0;	// during the last Update()
+		};
+
+		// At most `decodeJobs` images are decoded at once, the job system's other threads stay
+		// free for frame work
+		TextureLoader(JobSystem& jobs, uint decodeJobs = 2, uint uploadBudget = 8 * 1024 * 1024, bool generateMips = true);
+		~TextureLoader();
+
+		TextureLoader(const TextureLoader&) = delete;
+		TextureLoader& operator=(const TextureLoader&) = delete;
+
+		// Textures still loading or alive from an earlier Load() of the same path are shared
+		std::shared_ptr<Texture> Load(const std::string& path);
+
+		// Render thread, once per frame
+		void Update();
+
+		uint GetPendingCount() const;
+		const Stats& GetStats() const { return m_stats; }
+	private:
+		struct Request {
+			std::string path;
+			std::weak_ptr<Texture> texture;
+		};
+
+		struct Job {
+			std::weak_ptr<Texture> texture;
+			TextureData data;
+			bool loaded = false;
+			bool allocated = false;
+			uint level = 0;			// level being uploaded
+			uint uploadedRows = 0;	// of that level, in rows of 4x4 blocks for compressed data
+		};
+
+		JobSystem& m_jobs;
+		uint m_decodeJobs;
+		uint m_uploadBudget;
+		bool m_generateMips;
+		StreamBuffer m_staging;
+		Stats m_stats;
+		std::unordered_map<std::string, std::weak_ptr<Texture>> m_textures;
+
+		mutable std::mutex m_mutex;
+		std::deque<Request> m_requests;	// guarded by m_mutex
+		std::deque<Job> m_decoded;		// guarded by m_mutex
+		uint m_decoding = 0;			// guarded by m_mutex
+		uint m_decoders = 0;			// running decode jobs, guarded by m_mutex
+		bool m_stopping = false;		// guarded by m_mutex
+		std::deque<Job> m_uploading;	// render thread only
+		JobCounter m_decodeCounter;
+	private:
+		// Body of a decode job, works through m_requests until it is empty
+		void Decode();
+		// Returns false when the budget ran out before the job finished
+		bool Upload(Job& job, uint& budget);
+	};
+}
@@ -0,0 +1,138 @@
+#include "TextureTable.h"
+
+namespace Lumen {
+	// std140 layout of one slot: uvec2 handle, uint layer, uint pad, vec4 uvTransform
+	struct TextureTableEntry {
+		uint handle[2];
+		uint layer;
+		uint pad;
+		float uvTransform[4];	// offset.xy, scale.xy
+	};
+	static_assert(sizeof(TextureTableEntry) == 32, "TextureTableEntry must match the std140 layout");
+
+	TextureTable::TextureTable(uint capacity, uint fallbackPageSize)
+		: m_capacity(capacity), m_bindless(GLExtensions::HasBindlessTexture()),
+		m_buffer(capacity * (uint)sizeof(TextureTableEntry)), m_pageSize(fallbackPageSize)
+	{
+	}
+
+	uint TextureTable::Add(const std::shared_ptr<Texture>& texture)
+	{
+		auto it = m_slots.find(texture.get());
+		if (it != m_slots.end()) {
+			return it->second;
+		}
+		if (m_textures.size() >= m_capacity) {
+			std::cerr << "TextureTable: all " << m_capacity << " slots are in use" << std::endl;
+			return 0;
+		}
+
+		const uint slot = (uint)m_textures.size();
+		m_textures.push_back(texture);
+		m_slots[texture.get()] = slot;
+		return slot;
+	}
+
+	void TextureTable::Clear()
+	{
+		m_textures.clear();
+		m_slots.clear();
+		m_atlas.reset();
+	}
+
+	bool TextureTable::Build()
+	{
+		std::vector<TextureTableEntry> entries(m_textures.size());
+
+		if (m_bindless) {
+			for (size_t i = 0; i < m_textures.size(); i++) {
+				const uint64_t handle = m_textures[i]->GetHandle();
+				if (!handle) {
+					std::cerr << "TextureTable: no bindless handle for texture " << m_textures[i]->GetID() << std::endl;
+					return false;
+				}
+				TextureTableEntry& entry = entries[i];
+				entry.handle[0] = (uint)(handle & 0xFFFFFFFF);
+				entry.handle[1] = (uint)(handle >> 32);
+				entry.uvTransform[2] = 1.0f;
+				entry.uvTransform[3] = 1.0f;
+			}
+		}
+		else {
+			m_atlas.reset(new TextureAtlas(m_pageSize));
+			for (const std::shared_ptr<Texture>& texture : m_textures) {
+				m_atlas->Add(*texture);
+			}
+			if (!m_atlas->Build(true, true)) {
+				return false;
+			}
+
+			for (size_t i = 0; i < m_textures.size(); i++) {
+				const AtlasRegion& region = m_atlas->GetRegion((uint)i);
+				TextureTableEntry& entry = entries[i];
+				entry.layer = region.layer;
+				entry.uvTransform[0] = region.offsetU;
+				entry.uvTransform[1] = region.offsetV;
+				entry.uvTransform[2] = region.scaleU;
+				entry.uvTransform[3] = region.scaleV;
+			}
+		}
+
+		if (!entries.empty()) {
+			m_buffer.SetBytes(0, entries.data(), (uint)(entries.size() * sizeof(TextureTableEntry)));
+		}
+		m_buffer.Upload();
+		return true;
+	}
+
+	void TextureTable::Bind(uint uniformBinding, uint textureSlot)
+	{
+		m_buffer.BindBase(uniformBinding);
+		if (m_atlas) {
+			m_atlas->Bind(textureSlot);
+		}
+	}
+
+	void TextureTable::ApplyDefines(ShaderDefines& defines) const
+	{
+		if (m_bindless) {
+			defines.Set("LUMEN_BINDLESS");
+		}
+		else {
+			defines.Remove("LUMEN_BINDLESS");
+		}
+		defines.Set("LUMEN_TEXTURE_TABLE_SIZE", (int)m_capacity);
+	}
+
+	const char *TextureTable::GetGLSL()
+	{
+		return
+			"#ifdef LUMEN_BINDLESS\n"
+			"#extension GL_ARB_bindless_texture : require\n"
+			"#endif\n"
+			"#ifndef LUMEN_TEXTURE_TABLE_SIZE\n"
+			"#define LUMEN_TEXTURE_TABLE_SIZE 256\n"
+			"#endif\n"
+			"struct LumenTextureEntry {\n"
+			"	uvec2 handle;\n"
+			"	uint layer;\n"
+			"	uint pad;\n"
+			"	vec4 uvTransform;\n"
+			"};\n"
+			"layout(std140) uniform LumenTextureTable {\n"
+			"	LumenTextureEntry lumenTextures[LUMEN_TEXTURE_TABLE_SIZE];\n"
+			"};\n"
+			"#ifdef LUMEN_BINDLESS\n"
+			"vec4 LumenTexture(uint index, vec2 uv) {\n"
+			"	LumenTextureEntry entry = lumenTextures[index];\n"
+			"	return texture(sampler2D(entry.handle), entry.uvTransform.xy + uv * entry.uvTransform.zw);\n"
+			"}\n"
+			"#else\n"
+			"uniform sampler2DArray lumenTextureArray;\n"
+			"vec4 LumenTexture(uint index, vec2 uv) {\n"
+			"	LumenTextureEntry entry = lumenTextures[index];\n"
+			"	return texture(lumenTextureArray, vec3(entry.uvTransform.xy + uv * entry.uvTransform.zw, float(entry.layer)));\n"
+			"}\n"
+			"#endif\n";
+	}
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <unordered_map>
+#include "types.h"
+#include "Textures.h"
+#include "TextureAtlas.h"
+#include "UniformBuffer.h"
+#include "ShaderPreprocessor.h"
+
+namespace Lumen {
+	// Lets a shader pick any of hundreds of textures by index, so draws with different
+	// materials no longer need a rebind between them and can share one multi-draw batch.
+	// With ARB_bindless_texture every slot holds the texture's resident handle. Without it
+	// (Mesa llvmpipe, older drivers) Build() copies the textures into the layers of a
+	// TextureAtlas array and each slot holds its layer and UV transform instead, which costs a
+	// readback at build time and loses wrapping, so keep repeating textures out of the table.
+	// Shaders include GetGLSL() and sample with LumenTexture(index, uv); the index has to be
+	// dynamically uniform (a per-draw value), as both the spec and the array fallback require.
+	class TextureTable {
+	public:
+		TextureTable(uint capacity = 256, uint fallbackPageSize = 2048);
+
+		TextureTable(const TextureTable&) = delete;
+		TextureTable& operator=(const TextureTable&) = delete;
+
+		// Returns the slot to pass to the shader, adding the same texture twice reuses its slot.
+		// Slots past the capacity return 0
+		uint Add(const std::shared_ptr<Texture>& texture);
+		void Clear();
+
+		// Writes the slots into the uniform buffer, call again after adding textures or after
+		// a TextureLoader replaced the placeholder of one of them
+		bool Build();
+
+		// Attaches the table to a uniform block binding and, for the fallback, the array
+		// texture to `textureSlot` (set the shader's lumenTextureArray sampler to it)
+		void Bind(uint uniformBinding = 0, uint textureSlot = 0);
+
+		bool IsBindless() const { return m_bindless; }
+		uint GetCount() const { return (uint)m_textures.size(); }
+		uint GetCapacity() const { return m_capacity; }
+
+		// Sets LUMEN_BINDLESS and LUMEN_TEXTURE_TABLE_SIZE to match this table
+		void ApplyDefines(ShaderDefines& defines) const;
+		// Block LumenTextureTable and vec4 LumenTexture(uint index, vec2 uv), to be placed
+		// right after #version since it may enable the bindless extension
+		static const char *GetGLSL();
+	private:
+		uint m_capacity;
+		bool m_bindless;
+		std::vector<std::shared_ptr<Texture>> m_textures;
+		std::unordered_map<const Texture*, uint> m_slots;
+		UniformBuffer m_buffer;
+		std::unique_ptr<TextureAtlas> m_atlas;	// fallback only
+		uint m_pageSize;
+	};
+}
@@ -1,51 +1,103 @@
 #include "Textures.h"
 
 namespace Lumen {
-	Texture::Texture(const std::string& path)
-		: m_id(0), m_filePath(path), m_localBuffer(nullptr), m_width(0), m_height(0), m_BPP(0)
+	Texture::Texture(const std::string& path, bool generateMips)
+		: m_id(0), m_filePath(path), m_width(0), m_height(0), m_levels(0), m_format(GL_RGBA8)
 	{
-		stbi_set_flip_vertically_on_load(1);
-		m_localBuffer = stbi_load(path.c_str(), &m_width, &m_height, &m_BPP, 4);
-
-		GLCall(glGenTextures(1, &m_id));
-		GLCall(glBindTexture(GL_TEXTURE_2D, m_id));
-
-		GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
-		GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
-		GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP));
-		GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP));
+		TextureData data;
+		if (!data.Load(path, generateMips)) {
+			data = TextureData::FromRGBA(0, 0, nullptr);
+		}
+		Create(data);
+	}
 
-		GLCall(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, m_width, m_height, 0, GL_RGBA, GL_UNSIGNED_BYTE, m_localBuffer));
-		GLCall(glBindTexture(GL_TEXTURE_2D, 0));
+	Texture::Texture(const TextureData& data)
+		: m_id(0), m_width(0), m_height(0), m_levels(0), m_format(GL_RGBA8)
+	{
+		Create(data);
+	}
 
-		if (m_localBuffer) {
-			stbi_image_free(m_localBuffer);
-		}
+	Texture::Texture(int width, int height, const unsigned char *pixels)
+		: m_id(0), m_width(0), m_height(0), m_levels(0), m_format(GL_RGBA8)
+	{
+		Create(TextureData::FromRGBA(width, height, pixels));
 	}
 
 	Texture::~Texture()
 	{
+		if (m_handle) {
+			GLCall(GLExtensions::MakeTextureHandleNonResident(m_handle));
+		}
 		GLCall(glDeleteTextures(1, &m_id));
+		GLState::DeleteTexture(m_id);
 	}
 
-	void Texture::Bind(uint slot) const
+	void Texture::Create(const TextureData& data)
 	{
-		GLCall(glActiveTexture(GL_TEXTURE0 + slot));
-		GLCall(glBindTexture(GL_TEXTURE_2D, m_id));
+		GLCall(glGenTextures(1, &m_id));
+		Allocate(data, true);
+		GLState::BindTexture(GL_TEXTURE_2D, 0);
 	}
 
-	void Texture::Unbind() const
+	bool Texture::Allocate(const TextureData& data, bool upload)
 	{
-		GLCall(glBindTexture(GL_TEXTURE_2D, 0));
+		if (data.IsCompressed() && !GLExtensions::IsCompressedFormatSupported(data.format)) {
+			std::cerr << "Texture: compressed format 0x" << std::hex << data.format << std::dec << " is not supported by this context" << std::endl;
+			return false;
+		}
+
+		if (m_handle) {
+			// a texture that has a bindless handle is immutable, swap in a fresh object
+			GLCall(GLExtensions::MakeTextureHandleNonResident(m_handle));
+			m_handle = 0;
+			GLCall(glDeleteTextures(1, &m_id));
+			GLState::DeleteTexture(m_id);
+			GLCall(glGenTextures(1, &m_id));
+		}
+
+		m_width = data.GetWidth();
+		m_height = data.GetHeight();
+		m_levels = (uint)data.levels.size();
+		m_format = data.format;
+
+		GLState::BindTexture(GL_TEXTURE_2D, m_id);
+		GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+		GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+		GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+		GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, m_levels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR));
+		GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, m_levels > 0 ? m_levels - 1 : 0));
+
+		for (uint i = 0; i < m_levels; i++) {
+			const TextureLevel& level = data.levels[i];
+			const unsigned char *pixels = upload && data.HasBytes() ? data.GetBytes() + level.offset : nullptr;
+			if (data.IsCompressed()) {
+				GLCall(glCompressedTexImage2D(GL_TEXTURE_2D, i, data.format, level.width, level.height, 0, (GLsizei)level.size, pixels));
+			}
+			else {
+				GLCall(glTexImage2D(GL_TEXTURE_2D, i, data.format, level.width, level.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels));
+			}
+		}
+		return true;
 	}
 
-	inline int Texture::GetWidth() const
+	uint64_t Texture::GetHandle() const
 	{
-		return m_width;
+		if (!m_handle && GLExtensions::HasBindlessTexture()) {
+			m_handle = GLExtensions::GetTextureHandle(m_id);
+			if (m_handle) {
+				GLCall(GLExtensions::MakeTextureHandleResident(m_handle));
+			}
+		}
+		return m_handle;
 	}
 
-	inline int Texture::GetHeight() const
+	void Texture::Bind(uint slot) const
+	{
+		GLState::BindTexture(GL_TEXTURE_2D, slot, m_id);
+	}
+
+	void Texture::Unbind() const
 	{
-		return m_height;
+		GLState::BindTexture(GL_TEXTURE_2D, 0);
 	}
 }
@@ -1,24 +1,54 @@
 #pragma once
 
+#include <string>
+#include <cstdint>
 #include "types.h"
 #include "Utils.h"
+#include "GLState.h"
+#include "TextureData.h"
 #include "external/stb_image.h"
 
 namespace Lumen {
 	class Texture {
 	public:
-		Texture(const std::string& path);
+		// .dds and .ktx2 load their stored mips (BC1/BC3/BC7 or RGBA8), other images are
+		// decoded with stb_image and get a box filtered chain unless generateMips is false
+		Texture(const std::string& path, bool generateMips = true);
+		Texture(const TextureData& data);
+		// RGBA8 texture from memory, `pixels` may be null to leave the contents undefined
+		Texture(int width, int height, const unsigned char *pixels);
 		~Texture();
 
+		Texture(const Texture&) = delete;
+		Texture& operator=(const Texture&) = delete;
+
 		void Bind(uint slot = 0) const;
 		void Unbind() const;
+		uint GetID() const { return m_id; }
+
+		int GetWidth() const { return m_width; }
+		int GetHeight() const { return m_height; }
+		uint GetLevelCount() const { return m_levels; }
 
-		inline int GetWidth() const;
-		inline int GetHeight() const;
+		// ARB_bindless_texture handle, created and made resident on first call; 0 without the
+		// extension. The texture's sampler state and storage are frozen from then on
+		uint64_t GetHandle() const;
+		GLenum GetFormat() const { return m_format; }
+		const std::string& GetPath() const { return m_filePath; }
 	private:
+		friend class TextureLoader;
+
 		uint m_id;
 		std::string m_filePath;
-		unsigned char *m_localBuffer;
-		int m_width, m_height, m_BPP;
+		int m_width, m_height;
+		uint m_levels;
+		GLenum m_format;
+		mutable uint64_t m_handle = 0;
+	private:
+		void Create(const TextureData& data);
+		// (Re)defines every level of `data` on the same texture object, uploading the pixels
+		// when `upload` is set. TextureLoader allocates first and streams the contents later.
+		// False if the context cannot sample the format
+		bool Allocate(const TextureData& data, bool upload);
 	};
 }
@@ -0,0 +1,108 @@
+#include "TransformPool.h"
+
+#include <iostream>
+#include <algorithm>
+
+namespace Lumen {
+	static_assert(sizeof(cx::Mat4) == 16 * sizeof(cx_float), "cx::Mat4 must be tightly packed for uploads");
+
+	static constexpr size_t TransformGrain = 1024;
+
+	void TransformPool::Reserve(size_t count)
+	{
+		m_positions.reserve(count);
+		m_rotations.reserve(count);
+		m_scales.reserve(count);
+		m_parents.reserve(count);
+		m_depths.reserve(count);
+		m_world.reserve(count);
+		m_levelOrder.reserve(count);
+	}
+
+	void TransformPool::Clear()
+	{
+		m_positions.clear();
+		m_rotations.clear();
+		m_scales.clear();
+		m_parents.clear();
+		m_depths.clear();
+		m_world.clear();
+		m_levelOrder.clear();
+		m_levelOffsets.clear();
+		m_levelsDirty = true;
+	}
+
+	uint TransformPool::Create(int parent, const cx::Vec3& position, const cx::Quat& rotation, const cx::Vec3& scale)
+	{
+		if (parent != NoParent && (parent < 0 || (size_t)parent >= m_parents.size())) {
+			std::cerr << "TransformPool: invalid parent " << parent << ", creating a root node" << std::endl;
+			parent = NoParent;
+		}
+
+		m_positions.push_back(position);
+		m_rotations.push_back(rotation);
+		m_scales.push_back(scale);
+		m_parents.push_back(parent);
+		m_depths.push_back(parent == NoParent ? 0 : m_depths[parent] + 1);
+		m_world.push_back(cx::Mat4::identity());
+		m_levelsDirty = true;
+
+		return (uint)(m_parents.size() - 1);
+	}
+
+	void TransformPool::Update(JobSystem *jobs)
+	{
+		if (m_levelsDirty) {
+			RebuildLevels();
+			m_levelsDirty = false;
+		}
+
+		for (size_t level = 0; level + 1 < m_levelOffsets.size(); level++) {
+			const uint *ids = m_levelOrder.data() + m_levelOffsets[level];
+			const size_t count = m_levelOffsets[level + 1] - m_levelOffsets[level];
+
+			if (jobs && count > TransformGrain) {
+				jobs->ParallelFor(count, TransformGrain, [this, ids](size_t begin, size_t end) {
+					UpdateRange(ids + begin, end - begin);
+				});
+			}
+			else {
+				UpdateRange(ids, count);
+			}
+		}
+	}
+
+	void TransformPool::RebuildLevels()
+	{
+		uint maxDepth = 0;
+		for (uint depth : m_depths) {
+			maxDepth = std::max(maxDepth, depth);
+		}
+
+		// counting sort of node ids by depth, keeps creation order inside a level
+		m_levelOffsets.assign(m_depths.empty() ? 1 : maxDepth + 2, 0);
+		for (uint depth : m_depths) {
+			m_levelOffsets[depth + 1]++;
+		}
+		for (size_t i = 1; i < m_levelOffsets.size(); i++) {
+			m_levelOffsets[i] += m_levelOffsets[i - 1];
+		}
+
+		std::vector<size_t> cursor(m_levelOffsets.begin(), m_levelOffsets.end() - 1);
+		m_levelOrder.resize(m_depths.size());
+		for (uint id = 0; id < m_depths.size(); id++) {
+			m_levelOrder[cursor[m_depths[id]]++] = id;
+		}
+	}
+
+	void TransformPool::UpdateRange(const uint *ids, size_t count)
+	{
+		for (size_t i = 0; i < count; i++) {
+			const uint id = ids[i];
+			const cx::Mat4 local = cx::Mat4::fromTRS(m_positions[id], m_rotations[id], m_scales[id]);
+			const int parent = m_parents[id];
+
+			m_world[id] = parent == NoParent ? local : m_world[parent] * local;
+		}
+	}
+}
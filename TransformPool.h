@@ -0,0 +1,58 @@
+#pragma once
+
+#include <vector>
+#include "types.h"
+#include "Math.h"
+#include "JobSystem.h"
+
+namespace Lumen {
+	// Structure-of-arrays storage for node transforms. A parent is always created before
+	// its children, so every parent index is smaller than the index of its child.
+	class TransformPool {
+	public:
+		static constexpr int NoParent = -1;
+
+		TransformPool() = default;
+
+		void Reserve(size_t count);
+		void Clear();
+		uint Create(int parent = NoParent,
+					const cx::Vec3& position = cx::Vec3::zero(),
+					const cx::Quat& rotation = cx::Quat::identity(),
+					const cx::Vec3& scale = cx::Vec3(1.0f));
+		size_t GetSize() const { return m_parents.size(); }
+
+		void SetPosition(uint id, const cx::Vec3& position) { m_positions[id] = position; }
+		void SetRotation(uint id, const cx::Quat& rotation) { m_rotations[id] = rotation; }
+		void SetScale(uint id, const cx::Vec3& scale) { m_scales[id] = scale; }
+		const cx::Vec3& GetPosition(uint id) const { return m_positions[id]; }
+		const cx::Quat& GetRotation(uint id) const { return m_rotations[id]; }
+		const cx::Vec3& GetScale(uint id) const { return m_scales[id]; }
+		int GetParent(uint id) const { return m_parents[id]; }
+
+		// Recomputes every world matrix, one hierarchy level at a time. Nodes of a level are
+		// spread over the job system when one is given, otherwise the update runs on the calling thread.
+		void Update(JobSystem *jobs = nullptr);
+
+		const cx::Mat4& GetWorldMatrix(uint id) const { return m_world[id]; }
+		const cx::Mat4 *GetWorldMatrices() const { return m_world.data(); }
+		// Row-major 4x4 matrices packed back to back, ready for a buffer upload
+		const cx_float *GetWorldMatrixData() const { return m_world.empty() ? nullptr : m_world[0].data(); }
+		size_t GetWorldMatrixDataSize() const { return m_world.size() * sizeof(cx::Mat4); }
+	private:
+		std::vector<cx::Vec3> m_positions;
+		std::vector<cx::Quat> m_rotations;
+		std::vector<cx::Vec3> m_scales;
+		std::vector<int> m_parents;
+		std::vector<uint> m_depths;
+		std::vector<cx::Mat4> m_world;
+
+		// node ids grouped by depth, rebuilt when nodes are added
+		std::vector<uint> m_levelOrder;
+		std::vector<size_t> m_levelOffsets;
+		bool m_levelsDirty = true;
+	private:
+		void RebuildLevels();
+		void UpdateRange(const uint *ids, size_t count);
+	};
+}
@@ -0,0 +1,202 @@
+#include "UniformBuffer.h"
+
+#include <cstring>
+#include <algorithm>
+
+namespace Lumen {
+	UniformField UniformBlock::GetField(const std::string& member) const
+	{
+		for (const UniformBlockMember& m : members) {
+			if (m.name == member) {
+				return m.field;
+			}
+		}
+		// arrays are reported as "name[0]"
+		for (const UniformBlockMember& m : members) {
+			if (m.arraySize > 0 && m.name.size() == member.size() + 3 && m.name.compare(0, member.size(), member) == 0) {
+				return m.field;
+			}
+		}
+		return UniformField();
+	}
+
+	UniformField Std140Layout::Push(uint align, uint size, uint count, uint columns)
+	{
+		UniformField field;
+		if (count > 1 || columns > 0) {
+			// array elements and matrix columns are each rounded up to a vec4
+			align = 16;
+		}
+		const uint stride = columns > 0 ? columns * 16 : (size + 15) & ~15u;
+
+		m_size = (m_size + align - 1) & ~(align - 1);
+		field.offset = (int)m_size;
+		field.arrayStride = count > 1 ? stride : 0;
+		field.matrixStride = 16;
+		m_size += count > 1 ? stride * count : (columns > 0 ? stride : size);
+		return field;
+	}
+
+	template<> UniformField Std140Layout::Push<float>(uint count) { return Push(4, 4, count, 0); }
+	template<> UniformField Std140Layout::Push<int>(uint count) { return Push(4, 4, count, 0); }
+	template<> UniformField Std140Layout::Push<uint>(uint count) { return Push(4, 4, count, 0); }
+	template<> UniformField Std140Layout::Push<cx::Vec2>(uint count) { return Push(8, 8, count, 0); }
+	template<> UniformField Std140Layout::Push<cx::Vec3>(uint count) { return Push(16, 12, count, 0); }
+	template<> UniformField Std140Layout::Push<cx::Vec4>(uint count) { return Push(16, 16, count, 0); }
+	template<> UniformField Std140Layout::Push<cx::Mat3>(uint count) { return Push(16, 0, count, 3); }
+	template<> UniformField Std140Layout::Push<cx::Mat4>(uint count) { return Push(16, 0, count, 4); }
+
+	UniformBuffer::UniformBuffer(uint size, GLenum usage)
+	{
+		Create(size, usage);
+	}
+
+	UniformBuffer::UniformBuffer(const UniformBlock& block, GLenum usage)
+		: m_block(block), m_hasBlock(true)
+	{
+		Create(block.size, usage);
+	}
+
+	UniformBuffer::~UniformBuffer()
+	{
+		GLCall(glDeleteBuffers(1, &m_id));
+		GLState::DeleteBuffer(m_id);
+	}
+
+	void UniformBuffer::Create(uint size, GLenum usage)
+	{
+		m_data.assign(size, 0);
+		m_dirtyBegin = size;
+
+		GLCall(glGenBuffers(1, &m_id));
+		Bind();
+		GLCall(glBufferData(GL_UNIFORM_BUFFER, size, m_data.data(), usage));
+	}
+
+	unsigned char *UniformBuffer::Prepare(const UniformField& field, uint index, uint size)
+	{
+		if (!field.IsValid()) {
+			return nullptr;
+		}
+		const uint offset = field.offset + index * field.arrayStride;
+		if (offset + size > m_data.size()) {
+			std::cerr << "UniformBuffer: write at " << offset << " past the end of a " << m_data.size() << " byte buffer" << std::endl;
+			return nullptr;
+		}
+
+		m_dirtyBegin = std::min(m_dirtyBegin, offset);
+		m_dirtyEnd = std::max(m_dirtyEnd, offset + size);
+		return m_data.data() + offset;
+	}
+
+	void UniformBuffer::Set(const UniformField& field, float value, uint index)
+	{
+		if (unsigned char *dst = Prepare(field, index, 4)) {
+			std::memcpy(dst, &value, 4);
+		}
+	}
+
+	void UniformBuffer::Set(const UniformField& field, int value, uint index)
+	{
+		if (unsigned char *dst = Prepare(field, index, 4)) {
+			std::memcpy(dst, &value, 4);
+		}
+	}
+
+	void UniformBuffer::Set(const UniformField& field, uint value, uint index)
+	{
+		if (unsigned char *dst = Prepare(field, index, 4)) {
+			std::memcpy(dst, &value, 4);
+		}
+	}
+
+	void UniformBuffer::Set(const UniformField& field, const cx::Vec2& value, uint index)
+	{
+		if (unsigned char *dst = Prepare(field, index, 8)) {
+			const float v[2] = { (float)value.data()[0], (float)value.data()[1] };
+			std::memcpy(dst, v, sizeof(v));
+		}
+	}
+
+	void UniformBuffer::Set(const UniformField& field, const cx::Vec3& value, uint index)
+	{
+		if (unsigned char *dst = Prepare(field, index, 12)) {
+			const cx_float *src = value.data();
+			const float v[3] = { (float)src[0], (float)src[1], (float)src[2] };
+			std::memcpy(dst, v, sizeof(v));
+		}
+	}
+
+	void UniformBuffer::Set(const UniformField& field, const cx::Vec4& value, uint index)
+	{
+		if (unsigned char *dst = Prepare(field, index, 16)) {
+			const cx_float *src = value.data();
+			const float v[4] = { (float)src[0], (float)src[1], (float)src[2], (float)src[3] };
+			std::memcpy(dst, v, sizeof(v));
+		}
+	}
+
+	void UniformBuffer::Set(const UniformField& field, const cx::Mat3& value, uint index)
+	{
+		WriteMatrix(field, value.data(), 3, index);
+	}
+
+	void UniformBuffer::Set(const UniformField& field, const cx::Mat4& value, uint index)
+	{
+		WriteMatrix(field, value.data(), 4, index);
+	}
+
+	void UniformBuffer::SetBytes(uint offset, const void *data, uint size)
+	{
+		UniformField field;
+		field.offset = (int)offset;
+		if (unsigned char *dst = Prepare(field, 0, size)) {
+			std::memcpy(dst, data, size);
+		}
+	}
+
+	void UniformBuffer::WriteMatrix(const UniformField& field, const cx_float *data, uint dimension, uint index)
+	{
+		unsigned char *dst = Prepare(field, index, field.matrixStride * (dimension - 1) + dimension * 4);
+		if (!dst) {
+			return;
+		}
+
+		// caylix matrices are row major, GLSL defaults to column major
+		for (uint i = 0; i < dimension; i++) {
+			float vector[4];
+			for (uint j = 0; j < dimension; j++) {
+				vector[j] = (float)(field.rowMajor ? data[i * dimension + j] : data[j * dimension + i]);
+			}
+			std::memcpy(dst + i * field.matrixStride, vector, dimension * 4);
+		}
+	}
+
+	void UniformBuffer::Upload()
+	{
+		if (m_dirtyBegin >= m_dirtyEnd) {
+			return;
+		}
+
+		Bind();
+		GLCall(glBufferSubData(GL_UNIFORM_BUFFER, m_dirtyBegin, m_dirtyEnd - m_dirtyBegin, m_data.data() + m_dirtyBegin));
+		m_dirtyBegin = (uint)m_data.size();
+		m_dirtyEnd = 0;
+	}
+
+	void UniformBuffer::BindBase(uint binding)
+	{
+		Upload();
+		GLCall(glBindBufferBase(GL_UNIFORM_BUFFER, binding, m_id));
+	}
+
+	void UniformBuffer::Bind() const
+	{
+		GLState::BindBuffer(GL_UNIFORM_BUFFER, m_id);
+	}
+
+	void UniformBuffer::Unbind() const
+	{
+		GLState::BindBuffer(GL_UNIFORM_BUFFER, 0);
+	}
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <glad/glad.h>
+#include "types.h"
+#include "Utils.h"
+#include "GLState.h"
+
+#include "Math.h"
+
+namespace Lumen {
+	// Where one value lives inside a uniform block. Built either by Std140Layout or from
+	// the reflected block of a linked program, then kept around so writes never look up names
+	struct UniformField {
+		int offset = -1;
+		uint arrayStride = 0;	// bytes between array elements, 0 for non arrays
+		uint matrixStride = 16;	// bytes between matrix columns (rows when rowMajor)
+		bool rowMajor = false;
+
+		bool IsValid() const { return offset >= 0; }
+	};
+
+	struct UniformBlockMember {
+		std::string name;
+		GLenum type;
+		int arraySize;
+		UniformField field;
+	};
+
+	struct UniformBlock {
+		std::string name;
+		uint index;
+		uint size;
+		std::vector<UniformBlockMember> members;
+
+		// Linear search, meant for setup code; keep the returned field for per frame writes
+		UniformField GetField(const std::string& member) const;
+	};
+
+	// Hands out offsets following the std140 rules, for blocks declared with layout(std140)
+	// whose layout is known up front and does not need a program to be queried
+	class Std140Layout {
+	public:
+		template<typename T>
+		UniformField Push(uint count = 1);
+
+		// Block size, padded to a multiple of a vec4
+		uint GetSize() const { return (m_size + 15) & ~15u; }
+	private:
+		uint m_size = 0;
+	private:
+		UniformField Push(uint align, uint size, uint count, uint columns);
+	};
+
+	template<> UniformField Std140Layout::Push<float>(uint count);
+	template<> UniformField Std140Layout::Push<int>(uint count);
+	template<> UniformField Std140Layout::Push<uint>(uint count);
+	template<> UniformField Std140Layout::Push<cx::Vec2>(uint count);
+	template<> UniformField Std140Layout::Push<cx::Vec3>(uint count);
+	template<> UniformField Std140Layout::Push<cx::Vec4>(uint count);
+	template<> UniformField Std140Layout::Push<cx::Mat3>(uint count);
+	template<> UniformField Std140Layout::Push<cx::Mat4>(uint count);
+
+	// Uniform buffer object with a CPU side copy. Set() only writes into the copy and widens
+	// the dirty range, Upload() sends the whole range with a single glBufferSubData.
+	// Matrices are transposed on write unless the field is row major, matching SetUniformMat*
+	class UniformBuffer {
+	public:
+		UniformBuffer(uint size, GLenum usage = GL_DYNAMIC_DRAW);
+		UniformBuffer(const UniformBlock& block, GLenum usage = GL_DYNAMIC_DRAW);
+		~UniformBuffer();
+
+		UniformBuffer(const UniformBuffer&) = delete;
+		UniformBuffer& operator=(const UniformBuffer&) = delete;
+
+		void Set(const UniformField& field, float value, uint index = 0);
+		void Set(const UniformField& field, int value, uint index = 0);
+		void Set(const UniformField& field, uint value, uint index = 0);
+		void Set(const UniformField& field, const cx::Vec2& value, uint index = 0);
+		void Set(const UniformField& field, const cx::Vec3& value, uint index = 0);
+		void Set(const UniformField& field, const cx::Vec4& value, uint index = 0);
+		void Set(const UniformField& field, const cx::Mat3& value, uint index = 0);
+		void Set(const UniformField& field, const cx::Mat4& value, uint index = 0);
+		void SetBytes(uint offset, const void *data, uint size);
+
+		// Sends the dirty range, no-op when nothing changed since the last upload
+		void Upload();
+		// Uploads if needed and attaches the buffer to a binding point
+		void BindBase(uint binding);
+		void Bind() const;
+		void Unbind() const;
+
+		uint GetID() const { return m_id; }
+		uint GetSize() const { return (uint)m_data.size(); }
+		const UniformBlock *GetBlock() const { return m_hasBlock ? &m_block : nullptr; }
+		UniformField GetField(const std::string& member) const { return m_block.GetField(member); }
+	private:
+		uint m_id;
+		std::vector<unsigned char> m_data;
+		uint m_dirtyBegin;
+		uint m_dirtyEnd = 0;
+		UniformBlock m_block;
+		bool m_hasBlock = false;
+	private:
+		void Create(uint size, GLenum usage);
+		void WriteMatrix(const UniformField& field, const cx_float *data, uint dimension, uint index);
+		unsigned char *Prepare(const UniformField& field, uint index, uint size);
+	};
+}
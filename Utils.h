@@ -2,6 +2,7 @@
 
 #include <iostream>
 #include <string>
+#include <cstdint>
 #include <glad/glad.h>
 
 #ifdef LUMEN_DEBUG
@@ -18,14 +19,32 @@
 
 #define ASSERT(x)	if (!(x))	DEBUG_BREAK
 #define GLCall(x)	\
-	GLClearError();	\
+	GLClearErrorPerCall();	\
 	x;				\
-	ASSERT(GLLogCall(#x, __FILE__, __LINE__))
+	ASSERT(GLLogCallPerCall(#x, __FILE__, __LINE__))
 #else
 #define GLCall(x)	(x)
 #endif
 
 
+// PerCall wraps every GLCall in glGetError loops (debug builds only),
+// PerFrame leaves it to one GLCheckErrors() per frame, done by Window::SwapBuffers
+enum class GLErrorCheck {
+	PerCall,
+	PerFrame,
+};
+
+inline GLErrorCheck& GLErrorCheckMode()
+{
+	static GLErrorCheck mode = GLErrorCheck::PerCall;
+	return mode;
+}
+
+inline void SetGLErrorCheckMode(GLErrorCheck mode)
+{
+	GLErrorCheckMode() = mode;
+}
+
 inline void GLClearError()
 {
 	while (glGetError() != GL_NO_ERROR);
@@ -40,3 +59,46 @@ inline bool GLLogCall(const char *function, const char *file, const int line)
 	}
 	return true;
 }
+
+inline void GLClearErrorPerCall()
+{
+	if (GLErrorCheckMode() == GLErrorCheck::PerCall) {
+		GLClearError();
+	}
+}
+
+inline bool GLLogCallPerCall(const char *function, const char *file, const int line)
+{
+	return GLErrorCheckMode() != GLErrorCheck::PerCall || GLLogCall(function, file, line);
+}
+
+// Drains the error queue once, reporting every error raised since the last check
+inline bool GLCheckErrors(const char *where)
+{
+	bool ok = true;
+	GLenum error;
+	while ((error = glGetError()) != GL_NO_ERROR) {
+		std::cerr << "[OpenGl Error] {" << error << "} during " << where << std::endl;
+		ok = false;
+	}
+	return ok;
+}
+
+// FNV-1a, chain calls by passing the previous result as `hash`
+inline uint64_t HashBytes(const void *data, size_t size, uint64_t hash = 0xCBF29CE484222325ull)
+{
+	const unsigned char *bytes = (const unsigned char *)data;
+	for (size_t i = 0; i < size; i++) {
+		hash ^= bytes[i];
+		hash *= 0x100000001B3ull;
+	}
+	return hash;
+}
+
+inline uint64_t HashString(const std::string& s, uint64_t hash = 0xCBF29CE484222325ull)
+{
+	// the length goes in too so ("ab", "c") and ("a", "bc") chain differently
+	const uint64_t size = s.size();
+	hash = HashBytes(&size, sizeof(size), hash);
+	return HashBytes(s.data(), s.size(), hash);
+}
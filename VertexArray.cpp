@@ -4,27 +4,59 @@ namespace Lumen {
 	VertexArray::VertexArray()
 	{
 		GLCall(glGenVertexArrays(1, &m_id));
-		GLCall(glBindVertexArray(m_id));
+		GLState::BindVertexArray(m_id);
 	}
 
 	VertexArray::~VertexArray()
 	{
 		GLCall(glDeleteVertexArrays(1, &m_id));
+		GLState::DeleteVertexArray(m_id);
 	}
 
 	void VertexArray::AddBuffer(const std::shared_ptr<VertexBuffer>& vb, const VertexBufferLayout& layout)
 	{
 		Bind();
 		vb->Bind();
+		AddAttributes(layout);
+	}
 
+	void VertexArray::AddBuffer(const std::shared_ptr<StreamBuffer>& sb, const VertexBufferLayout& layout)
+	{
+		Bind();
+		GLState::BindBuffer(GL_ARRAY_BUFFER, sb->GetID());
+		AddAttributes(layout);
+		m_streamBuffers.push_back(sb);
+	}
+
+	void VertexArray::AddIndexStream(const std::shared_ptr<StreamBuffer>& indexStream)
+	{
+		Bind();
+		GLState::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexStream->GetID());
+		m_streamBuffers.push_back(indexStream);
+	}
+
+	void VertexArray::AddAttributes(const VertexBufferLayout& layout)
+	{
 		const auto& elements = layout.GetElements();
 		uint offset = 0;
 
+		// attribute locations continue after the ones used by earlier buffers
 		for (uint i = 0; i < elements.size(); i++) {
 			const auto& element = elements[i];
-			GLCall(glEnableVertexAttribArray(i));
-			GLCall(glVertexAttribPointer(i, element.count, element.type, element.normalized, layout.GetStride(), (const void*)(size_t)offset));
-			offset += element.count * VertexBufferLayoutElement::GetSizeOfType(element.type);
+			const uint typeSize = VertexBufferLayoutElement::GetSizeOfType(element.type);
+
+			// elements wider than 4 components take one location per 4 components, so a row-major
+			// cx::Mat4 pushed as 16 floats shows up in GLSL as the transposed mat4
+			for (uint first = 0; first < element.count; first += 4) {
+				const uint count = std::min(element.count - first, 4u);
+				GLCall(glEnableVertexAttribArray(m_attribIndex));
+				GLCall(glVertexAttribPointer(m_attribIndex, count, element.type, element.normalized, layout.GetStride(), (const void*)(size_t)(offset + first * typeSize)));
+				if (element.divisor) {
+					GLCall(glVertexAttribDivisor(m_attribIndex, element.divisor));
+				}
+				m_attribIndex++;
+			}
+			offset += element.count * typeSize;
 		}
 	}
 
@@ -36,6 +68,10 @@ namespace Lumen {
 	void VertexArray::AddIndexBuffer(const std::shared_ptr<IndexBuffer>& indexBuffer)
 	{
 		m_indexBuffer = indexBuffer;
+
+		// record the element buffer in this vertex array object
+		Bind();
+		indexBuffer->Bind();
 	}
 
 	const std::vector<std::shared_ptr<VertexBuffer>>& VertexArray::GetVertexBuffers() const
@@ -50,11 +86,11 @@ namespace Lumen {
 
 	void VertexArray::Bind() const
 	{
-		GLCall(glBindVertexArray(m_id));
+		GLState::BindVertexArray(m_id);
 	}
 
 	void VertexArray::Unbind() const
 	{
-		GLCall(glBindVertexArray(0));
+		GLState::BindVertexArray(0);
 	}
 }
@@ -2,9 +2,12 @@
 
 #include "VertexBuffer.h"
 #include "IndexBuffer.h"
+#include "StreamBuffer.h"
 #include "VertexBufferLayout.h"
 #include "Utils.h"
+#include "GLState.h"
 #include <memory>
+#include <algorithm>
 
 namespace Lumen {
 	class VertexArray {
@@ -14,6 +17,9 @@ namespace Lumen {
 
 
 		void AddBuffer(const std::shared_ptr<VertexBuffer>& vb, const VertexBufferLayout& layout);
+		// Attributes start at offset 0 of the ring, draw with a base vertex of span.offset / stride
+		void AddBuffer(const std::shared_ptr<StreamBuffer>& sb, const VertexBufferLayout& layout);
+		void AddIndexStream(const std::shared_ptr<StreamBuffer>& indexStream);
 
 		void AddVertexBuffer(const std::shared_ptr<VertexBuffer>& vertexBuffer);
 		void AddIndexBuffer(const std::shared_ptr<IndexBuffer>& indexBuffer);
@@ -22,9 +28,14 @@ namespace Lumen {
 
 		void Bind() const;
 		void Unbind() const;
+		uint GetID() const { return m_id; }
 	private:
 		uint m_id;
+		uint m_attribIndex = 0;
 		std::vector<std::shared_ptr<VertexBuffer>> m_vertexBuffer;
 		std::shared_ptr<IndexBuffer> m_indexBuffer;
+		std::vector<std::shared_ptr<StreamBuffer>> m_streamBuffers;
+	private:
+		void AddAttributes(const VertexBufferLayout& layout);
 	};
 }
@@ -2,16 +2,31 @@
 
 namespace Lumen {
 	VertexBuffer::VertexBuffer(const void *data, uint size, GLenum usage)
-		: m_id(0), m_size(size)
+		: m_id(0), m_size(size), m_usage(usage)
 	{
 		GLCall(glGenBuffers(1, &m_id));
-		GLCall(glBindBuffer(GL_ARRAY_BUFFER, m_id));
+		GLState::BindBuffer(GL_ARRAY_BUFFER, m_id);
 		GLCall(glBufferData(GL_ARRAY_BUFFER, size, data, usage));
 	}
 
 	VertexBuffer::~VertexBuffer()
 	{
 		GLCall(glDeleteBuffers(1, &m_id));
+		GLState::DeleteBuffer(m_id);
+	}
+
+	void VertexBuffer::SetData(const void *data, uint size)
+	{
+		Bind();
+		GLCall(glBufferData(GL_ARRAY_BUFFER, size, nullptr, m_usage));
+		GLCall(glBufferSubData(GL_ARRAY_BUFFER, 0, size, data));
+		m_size = size;
+	}
+
+	void VertexBuffer::SetSubData(const void *data, uint size, uint offset)
+	{
+		Bind();
+		GLCall(glBufferSubData(GL_ARRAY_BUFFER, offset, size, data));
 	}
 
 	uint VertexBuffer::GetSize() const
@@ -21,11 +36,11 @@ namespace Lumen {
 
 	void VertexBuffer::Bind() const
 	{
-		GLCall(glBindBuffer(GL_ARRAY_BUFFER, m_id));
+		GLState::BindBuffer(GL_ARRAY_BUFFER, m_id);
 	}
 
 	void VertexBuffer::Unbind() const
 	{
-		GLCall(glBindBuffer(GL_ARRAY_BUFFER, 0));
+		GLState::BindBuffer(GL_ARRAY_BUFFER, 0);
 	}
 }
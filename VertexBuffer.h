@@ -3,6 +3,7 @@
 #include "types.h"
 #include <glad/glad.h>
 #include "Utils.h"
+#include "GLState.h"
 
 namespace Lumen {
 	class VertexBuffer {
@@ -10,11 +11,16 @@ namespace Lumen {
 		VertexBuffer(const void *data, uint size, GLenum usage = GL_STATIC_DRAW);
 		~VertexBuffer();
 
+		// Replaces the whole store, orphaning the old one so the GPU never waits on it
+		void SetData(const void *data, uint size);
+		void SetSubData(const void *data, uint size, uint offset = 0);
+
 		uint GetSize() const;
 		void Bind() const;
 		void Unbind() const;
 	private:
 		uint m_size;
 		uint m_id;
+		GLenum m_usage;
 	};
 }
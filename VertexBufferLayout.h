@@ -9,6 +9,7 @@ namespace Lumen {
         uint type;
         uint count;
         unsigned char normalized; // Use unsigned char for GL_TRUE/GL_FALSE
+        uint divisor;             // 0 = per vertex, N = advance once every N instances
 
         static uint GetSizeOfType(uint type) {
             switch(type) {
@@ -22,33 +23,41 @@ namespace Lumen {
 
     class VertexBufferLayout {
     public:
-        VertexBufferLayout() : m_stride(0) {}
+        VertexBufferLayout(uint divisor = 0) : m_stride(0), m_divisor(divisor) {}
 
         template<typename T>
         void Push(uint count) { }
 
+        // Runtime counterpart of Push<T>, for layouts read back from files
+        void PushElement(uint type, uint count, unsigned char normalized) {
+            m_elements.push_back({ type, count, normalized, m_divisor });
+            m_stride += count * VertexBufferLayoutElement::GetSizeOfType(type);
+        }
+
         inline const std::vector<VertexBufferLayoutElement>& GetElements() const { return m_elements; }
         inline uint GetStride() const { return m_stride; }
+        inline uint GetDivisor() const { return m_divisor; }
 	private:
 		std::vector<VertexBufferLayoutElement> m_elements;
 		uint m_stride;
+		uint m_divisor;
     };
 
     template<>
     inline void VertexBufferLayout::Push<float>(uint count) {
-        m_elements.push_back({ GL_FLOAT, count, GL_FALSE });
+        m_elements.push_back({ GL_FLOAT, count, GL_FALSE, m_divisor });
         m_stride += count * VertexBufferLayoutElement::GetSizeOfType(GL_FLOAT);
     }
 
     template<>
     inline void VertexBufferLayout::Push<uint>(uint count) {
-        m_elements.push_back({ GL_UNSIGNED_INT, count, GL_FALSE });
+        m_elements.push_back({ GL_UNSIGNED_INT, count, GL_FALSE, m_divisor });
         m_stride += count * VertexBufferLayoutElement::GetSizeOfType(GL_UNSIGNED_INT);
     }
 
     template<>
     inline void VertexBufferLayout::Push<unsigned char>(uint count) {
-        m_elements.push_back({ GL_UNSIGNED_BYTE, count, GL_TRUE });
+        m_elements.push_back({ GL_UNSIGNED_BYTE, count, GL_TRUE, m_divisor });
         m_stride += count * VertexBufferLayoutElement::GetSizeOfType(GL_UNSIGNED_BYTE);
     }
 }
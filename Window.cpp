@@ -1,4 +1,6 @@
 #include "Window.h"
+#include "GLState.h"
+#include "GLExtensions.h"
 
 
 namespace Lumen {
@@ -19,6 +21,8 @@ namespace Lumen {
             std::cerr << "Failed to initialize GLAD\n";
             return;
         }
+		GLState::Invalidate();
+		GLExtensions::Load((GLADloadproc)glfwGetProcAddress);
 
 		glfwSetFramebufferSizeCallback(m_window, FrameBufferSizeCallback);
     }
@@ -45,6 +49,11 @@ namespace Lumen {
 
     void Window::SwapBuffers() const
     {
+#ifdef LUMEN_DEBUG
+		if (GLErrorCheckMode() == GLErrorCheck::PerFrame) {
+			GLCheckErrors("frame");
+		}
+#endif
         glfwSwapBuffers(m_window);
     }
 
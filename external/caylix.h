@@ -8,6 +8,25 @@
 #ifndef CAYLIX_H
 #define CAYLIX_H
 
+/* SIMD backend selection (compile time)                                */
+/* CX_SIMD_AVX2 / CX_SIMD_SSE / CX_SIMD_NEON are set from the compiler  */
+/* target flags, define CX_NO_SIMD to force the scalar fallback.        */
+/* Only single precision cx_float has vector paths.                     */
+/* Intrinsic headers are kept outside of the extern "C" block.          */
+#if !defined(CX_NO_SIMD) && !defined(CX_DOUBLE_PRECISION_FLOAT)
+#	if defined(__AVX2__)
+#		define CX_SIMD_AVX2
+#		define CX_SIMD_SSE
+#		include <immintrin.h>
+#	elif defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#		define CX_SIMD_SSE
+#		include <emmintrin.h>
+#	elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+#		define CX_SIMD_NEON
+#		include <arm_neon.h>
+#	endif
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif /* __cplusplus */
@@ -43,8 +62,14 @@ extern "C" {
 #   endif
 #endif
 
+/** C99 complex arithmetic (I, cabsf, crealf, ...) has no C++ counterpart and <complex.h> cannot
+ * be included inside extern "C", so the dft/fft code only builds in C translation units */
+#if defined(__cplusplus) && !defined(CX_NO_FFT)
+#   define CX_NO_FFT
+#endif
+
 /** typecast cx_float complex as cx_complex */
-#ifndef cx_complex
+#if !defined(cx_complex) && !defined(CX_NO_FFT)
 #   include <complex.h>
 /** https://learn.microsoft.com/en-us/cpp/c-runtime-library/complex-math-support?view=msvc-170 */
 #   ifdef _MSC_VER
@@ -737,12 +762,15 @@ CX_API CX_API_INLINE cx_mat4 cx_mat4_sub(const cx_mat4 a, const cx_mat4 b);
 CX_API CX_API_INLINE cx_mat4 cx_mat4_mulf(const cx_mat4 a, const cx_float fT);
 CX_API CX_API_INLINE cx_mat4 cx_mat4_divf(const cx_mat4 a, const cx_float fT);
 CX_API CX_API_INLINE cx_mat4 cx_mat4_mul(const cx_mat4 a, const cx_mat4 b);
+CX_API CX_API_INLINE void cx_mat4_mul_ref(const cx_mat4 *a, const cx_mat4 *b, cx_mat4 *out);                      /* *out = *a * *b, out may alias a or b */
 CX_API CX_API_INLINE cx_vec4 cx_mat4_vec4_mul(const cx_mat4 a, const cx_vec4 u);
 CX_API CX_API_INLINE cx_vec4 cx_mat4_vec4_project(const cx_mat4 a, const cx_vec4 u);
+CX_API CX_API_INLINE void cx_mat4_transform_vec4_array(const cx_mat4 *a, const cx_vec4 *in, cx_vec4 *out, size_t count);  /* out[i] = *a * in[i], out may alias in */
 
 CX_API CX_API_INLINE cx_float cx_mat4_det(const cx_mat4 a);
 CX_API CX_API_INLINE cx_mat4 cx_mat4_transpose(const cx_mat4 a);
 CX_API CX_API_INLINE cx_mat4 cx_mat4_inverse(const cx_mat4 a);
+CX_API CX_API_INLINE void cx_mat4_inverse_ref(const cx_mat4 *a, cx_mat4 *out);                                    /* *out = inverse(*a), zero matrix if singular */
 CX_API CX_API_INLINE cx_float cx_mat4_trace(const cx_mat4 a);
 
 CX_API CX_API_INLINE cx_mat4 cx_mat4_rotation_z(const cx_float angle);
@@ -756,6 +784,7 @@ CX_API CX_API_INLINE cx_vec4 cx_mat4_rotate_x(const cx_vec4 u, const cx_float an
 CX_API CX_API_INLINE cx_vec4 cx_mat4_rotate(const cx_vec4 u, const cx_float psi, const cx_float theta, const cx_float phi);
 
 CX_API CX_API_INLINE cx_mat4 cx_mat4_from_quat(const cx_quat p);
+CX_API CX_API_INLINE cx_mat4 cx_mat4_from_trs(const cx_vec3 t, const cx_quat r, const cx_vec3 s);           /* translation * from_quat(r) * scaling without the temporaries */
 
 CX_API CX_API_INLINE void cx_mat4_print(const cx_mat4 a);
 
@@ -1976,10 +2005,92 @@ CX_API CX_API_INLINE cx_mat4 cx_mat4_divf(const cx_mat4 a, const cx_float fT)
 
 CX_API CX_API_INLINE cx_mat4 cx_mat4_mul(const cx_mat4 a, const cx_mat4 b)
 {
-	return cx_mat4_set(a.m00 * b.m00 + a.m01 * b.m10 + a.m02 * b.m20 + a.m03 * b.m30, a.m00 * b.m01 + a.m01 * b.m11 + a.m02 * b.m21 + a.m03 * b.m31, a.m00 * b.m02 + a.m01 * b.m12 + a.m02 * b.m22 + a.m03 * b.m32, a.m00 * b.m03 + a.m01 * b.m13 + a.m02 * b.m23 + a.m03 * b.m33,
-		               a.m10 * b.m00 + a.m11 * b.m10 + a.m12 * b.m20 + a.m13 * b.m30, a.m10 * b.m01 + a.m11 * b.m11 + a.m12 * b.m21 + a.m13 * b.m31, a.m10 * b.m02 + a.m11 * b.m12 + a.m12 * b.m22 + a.m13 * b.m32, a.m10 * b.m03 + a.m11 * b.m13 + a.m12 * b.m23 + a.m13 * b.m33,
-		               a.m20 * b.m00 + a.m21 * b.m10 + a.m22 * b.m20 + a.m23 * b.m30, a.m20 * b.m01 + a.m21 * b.m11 + a.m22 * b.m21 + a.m23 * b.m31, a.m20 * b.m02 + a.m21 * b.m12 + a.m22 * b.m22 + a.m23 * b.m32, a.m20 * b.m03 + a.m21 * b.m13 + a.m22 * b.m23 + a.m23 * b.m33,
-		               a.m30 * b.m00 + a.m31 * b.m10 + a.m32 * b.m20 + a.m33 * b.m30, a.m30 * b.m01 + a.m31 * b.m11 + a.m32 * b.m21 + a.m33 * b.m31, a.m30 * b.m02 + a.m31 * b.m12 + a.m32 * b.m22 + a.m33 * b.m32, a.m30 * b.m03 + a.m31 * b.m13 + a.m32 * b.m23 + a.m33 * b.m33);
+	cx_mat4 result;
+	cx_mat4_mul_ref(&a, &b, &result);
+	return result;
+}
+
+CX_API CX_API_INLINE void cx_mat4_mul_ref(const cx_mat4 *a, const cx_mat4 *b, cx_mat4 *out)
+{
+#if defined(CX_SIMD_AVX2)
+	/* two rows of the result per iteration, b rows broadcast into both 128-bit lanes */
+	const __m256 b0 = _mm256_broadcast_ps((const __m128 *)&b->m[0]);
+	const __m256 b1 = _mm256_broadcast_ps((const __m128 *)&b->m[4]);
+	const __m256 b2 = _mm256_broadcast_ps((const __m128 *)&b->m[8]);
+	const __m256 b3 = _mm256_broadcast_ps((const __m128 *)&b->m[12]);
+
+	const __m256 a01 = _mm256_loadu_ps(&a->m[0]);
+	const __m256 a23 = _mm256_loadu_ps(&a->m[8]);
+
+#	if defined(__FMA__)
+	__m256 r01 = _mm256_mul_ps(_mm256_shuffle_ps(a01, a01, 0x00), b0);
+	r01 = _mm256_fmadd_ps(_mm256_shuffle_ps(a01, a01, 0x55), b1, r01);
+	r01 = _mm256_fmadd_ps(_mm256_shuffle_ps(a01, a01, 0xAA), b2, r01);
+	r01 = _mm256_fmadd_ps(_mm256_shuffle_ps(a01, a01, 0xFF), b3, r01);
+
+	__m256 r23 = _mm256_mul_ps(_mm256_shuffle_ps(a23, a23, 0x00), b0);
+	r23 = _mm256_fmadd_ps(_mm256_shuffle_ps(a23, a23, 0x55), b1, r23);
+	r23 = _mm256_fmadd_ps(_mm256_shuffle_ps(a23, a23, 0xAA), b2, r23);
+	r23 = _mm256_fmadd_ps(_mm256_shuffle_ps(a23, a23, 0xFF), b3, r23);
+#	else
+	__m256 r01 = _mm256_mul_ps(_mm256_shuffle_ps(a01, a01, 0x00), b0);
+	r01 = _mm256_add_ps(r01, _mm256_mul_ps(_mm256_shuffle_ps(a01, a01, 0x55), b1));
+	r01 = _mm256_add_ps(r01, _mm256_mul_ps(_mm256_shuffle_ps(a01, a01, 0xAA), b2));
+	r01 = _mm256_add_ps(r01, _mm256_mul_ps(_mm256_shuffle_ps(a01, a01, 0xFF), b3));
+
+	__m256 r23 = _mm256_mul_ps(_mm256_shuffle_ps(a23, a23, 0x00), b0);
+	r23 = _mm256_add_ps(r23, _mm256_mul_ps(_mm256_shuffle_ps(a23, a23, 0x55), b1));
+	r23 = _mm256_add_ps(r23, _mm256_mul_ps(_mm256_shuffle_ps(a23, a23, 0xAA), b2));
+	r23 = _mm256_add_ps(r23, _mm256_mul_ps(_mm256_shuffle_ps(a23, a23, 0xFF), b3));
+#	endif
+
+	_mm256_storeu_ps(&out->m[0], r01);
+	_mm256_storeu_ps(&out->m[8], r23);
+#elif defined(CX_SIMD_SSE)
+	/* row i of the result = a_i0 * b_row0 + a_i1 * b_row1 + a_i2 * b_row2 + a_i3 * b_row3 */
+	const __m128 b0 = _mm_loadu_ps(&b->m[0]);
+	const __m128 b1 = _mm_loadu_ps(&b->m[4]);
+	const __m128 b2 = _mm_loadu_ps(&b->m[8]);
+	const __m128 b3 = _mm_loadu_ps(&b->m[12]);
+
+	for (int i = 0; i < 4; i++) {
+		const __m128 row = _mm_loadu_ps(&a->m[i * 4]);
+
+		__m128 r = _mm_mul_ps(_mm_shuffle_ps(row, row, 0x00), b0);
+		r = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(row, row, 0x55), b1));
+		r = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(row, row, 0xAA), b2));
+		r = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(row, row, 0xFF), b3));
+
+		_mm_storeu_ps(&out->m[i * 4], r);
+	}
+#elif defined(CX_SIMD_NEON)
+	const float32x4_t b0 = vld1q_f32(&b->m[0]);
+	const float32x4_t b1 = vld1q_f32(&b->m[4]);
+	const float32x4_t b2 = vld1q_f32(&b->m[8]);
+	const float32x4_t b3 = vld1q_f32(&b->m[12]);
+
+	for (int i = 0; i < 4; i++) {
+		const float32x4_t row = vld1q_f32(&a->m[i * 4]);
+		const float32x2_t lo = vget_low_f32(row);
+		const float32x2_t hi = vget_high_f32(row);
+
+		float32x4_t r = vmulq_lane_f32(b0, lo, 0);
+		r = vmlaq_lane_f32(r, b1, lo, 1);
+		r = vmlaq_lane_f32(r, b2, hi, 0);
+		r = vmlaq_lane_f32(r, b3, hi, 1);
+
+		vst1q_f32(&out->m[i * 4], r);
+	}
+#else
+	cx_mat4 r;
+	for (int i = 0; i < 4; i++) {
+		for (int j = 0; j < 4; j++) {
+			r.m[i * 4 + j] = a->m[i * 4 + 0] * b->m[0 * 4 + j] + a->m[i * 4 + 1] * b->m[1 * 4 + j] +
+			                 a->m[i * 4 + 2] * b->m[2 * 4 + j] + a->m[i * 4 + 3] * b->m[3 * 4 + j];
+		}
+	}
+	*out = r;
+#endif
 }
 
 CX_API CX_API_INLINE cx_vec4 cx_mat4_vec4_mul(const cx_mat4 a, const cx_vec4 u)
@@ -2002,11 +2113,84 @@ CX_API CX_API_INLINE cx_vec4 cx_mat4_vec4_project(const cx_mat4 a, const cx_vec4
 	return result;
 }
 
+CX_API CX_API_INLINE void cx_mat4_transform_vec4_array(const cx_mat4 *a, const cx_vec4 *in, cx_vec4 *out, size_t count)
+{
+	size_t i = 0;
+#if defined(CX_SIMD_SSE)
+	/* out = c0 * x + c1 * y + c2 * z + c3 * w, with c0..c3 the columns of a */
+	__m128 c0 = _mm_loadu_ps(&a->m[0]);
+	__m128 c1 = _mm_loadu_ps(&a->m[4]);
+	__m128 c2 = _mm_loadu_ps(&a->m[8]);
+	__m128 c3 = _mm_loadu_ps(&a->m[12]);
+	_MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+
+#	if defined(CX_SIMD_AVX2)
+	const __m256 w0 = _mm256_set_m128(c0, c0);
+	const __m256 w1 = _mm256_set_m128(c1, c1);
+	const __m256 w2 = _mm256_set_m128(c2, c2);
+	const __m256 w3 = _mm256_set_m128(c3, c3);
+
+	for (; i + 2 <= count; i += 2) {
+		const __m256 v = _mm256_loadu_ps(in[i].vec);
+
+		__m256 r = _mm256_mul_ps(_mm256_shuffle_ps(v, v, 0x00), w0);
+		r = _mm256_add_ps(r, _mm256_mul_ps(_mm256_shuffle_ps(v, v, 0x55), w1));
+		r = _mm256_add_ps(r, _mm256_mul_ps(_mm256_shuffle_ps(v, v, 0xAA), w2));
+		r = _mm256_add_ps(r, _mm256_mul_ps(_mm256_shuffle_ps(v, v, 0xFF), w3));
+
+		_mm256_storeu_ps(out[i].vec, r);
+	}
+#	endif
+
+	for (; i < count; i++) {
+		const __m128 v = _mm_loadu_ps(in[i].vec);
+
+		__m128 r = _mm_mul_ps(_mm_shuffle_ps(v, v, 0x00), c0);
+		r = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(v, v, 0x55), c1));
+		r = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(v, v, 0xAA), c2));
+		r = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(v, v, 0xFF), c3));
+
+		_mm_storeu_ps(out[i].vec, r);
+	}
+#elif defined(CX_SIMD_NEON)
+	const float32x4x4_t c = vld4q_f32(a->m);    /* de-interleaving load gives the columns */
+
+	for (; i < count; i++) {
+		const float32x4_t v = vld1q_f32(in[i].vec);
+		const float32x2_t lo = vget_low_f32(v);
+		const float32x2_t hi = vget_high_f32(v);
+
+		float32x4_t r = vmulq_lane_f32(c.val[0], lo, 0);
+		r = vmlaq_lane_f32(r, c.val[1], lo, 1);
+		r = vmlaq_lane_f32(r, c.val[2], hi, 0);
+		r = vmlaq_lane_f32(r, c.val[3], hi, 1);
+
+		vst1q_f32(out[i].vec, r);
+	}
+#endif
+	for (; i < count; i++) {
+		out[i] = cx_mat4_vec4_mul(*a, in[i]);
+	}
+}
+
 CX_API CX_API_INLINE cx_float cx_mat4_det(const cx_mat4 a)
 {
-	/* TODO: Implement determinent for mat4 */
-	(void) a;
-	return 0.0;
+	/* Laplace expansion over the 2x2 minors of the top and bottom row pairs */
+	const cx_float s0 = a.m00 * a.m11 - a.m10 * a.m01;
+	const cx_float s1 = a.m00 * a.m12 - a.m10 * a.m02;
+	const cx_float s2 = a.m00 * a.m13 - a.m10 * a.m03;
+	const cx_float s3 = a.m01 * a.m12 - a.m11 * a.m02;
+	const cx_float s4 = a.m01 * a.m13 - a.m11 * a.m03;
+	const cx_float s5 = a.m02 * a.m13 - a.m12 * a.m03;
+
+	const cx_float c5 = a.m22 * a.m33 - a.m32 * a.m23;
+	const cx_float c4 = a.m21 * a.m33 - a.m31 * a.m23;
+	const cx_float c3 = a.m21 * a.m32 - a.m31 * a.m22;
+	const cx_float c2 = a.m20 * a.m33 - a.m30 * a.m23;
+	const cx_float c1 = a.m20 * a.m32 - a.m30 * a.m22;
+	const cx_float c0 = a.m20 * a.m31 - a.m30 * a.m21;
+
+	return s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
 }
 
 CX_API CX_API_INLINE cx_mat4 cx_mat4_transpose(const cx_mat4 a)
@@ -2019,9 +2203,121 @@ CX_API CX_API_INLINE cx_mat4 cx_mat4_transpose(const cx_mat4 a)
 
 CX_API CX_API_INLINE cx_mat4 cx_mat4_inverse(const cx_mat4 a)
 {
-	/* TODO: Implement inverse for mat4 */
-	(void) a;
-	return cx_mat4_identity();
+	cx_mat4 result;
+	cx_mat4_inverse_ref(&a, &result);
+	return result;
+}
+
+CX_API CX_API_INLINE void cx_mat4_inverse_ref(const cx_mat4 *a, cx_mat4 *out)
+{
+#if defined(CX_SIMD_SSE)
+	/* blockwise inverse over the 2x2 sub matrices A B / C D, each held in one register */
+#	define _CX_SWZ(v, x, y, z, w)      _mm_shuffle_ps((v), (v), _MM_SHUFFLE((w), (z), (y), (x)))
+#	define _CX_SHUF(u, v, x, y, z, w)  _mm_shuffle_ps((u), (v), _MM_SHUFFLE((w), (z), (y), (x)))
+	/* 2x2 A * B, A# * B and A * B#, where # is the adjugate */
+#	define _CX_M2_MUL(u, v)      _mm_add_ps(_mm_mul_ps((u), _CX_SWZ((v), 0, 3, 0, 3)), _mm_mul_ps(_CX_SWZ((u), 1, 0, 3, 2), _CX_SWZ((v), 2, 1, 2, 1)))
+#	define _CX_M2_ADJ_MUL(u, v)  _mm_sub_ps(_mm_mul_ps(_CX_SWZ((u), 3, 3, 0, 0), (v)), _mm_mul_ps(_CX_SWZ((u), 1, 1, 2, 2), _CX_SWZ((v), 2, 3, 0, 1)))
+#	define _CX_M2_MUL_ADJ(u, v)  _mm_sub_ps(_mm_mul_ps((u), _CX_SWZ((v), 3, 0, 3, 0)), _mm_mul_ps(_CX_SWZ((u), 1, 0, 3, 2), _CX_SWZ((v), 2, 1, 2, 1)))
+
+	const __m128 r0 = _mm_loadu_ps(&a->m[0]);
+	const __m128 r1 = _mm_loadu_ps(&a->m[4]);
+	const __m128 r2 = _mm_loadu_ps(&a->m[8]);
+	const __m128 r3 = _mm_loadu_ps(&a->m[12]);
+
+	const __m128 A = _mm_movelh_ps(r0, r1);
+	const __m128 B = _mm_movehl_ps(r1, r0);
+	const __m128 C = _mm_movelh_ps(r2, r3);
+	const __m128 D = _mm_movehl_ps(r3, r2);
+
+	/* |A|, |B|, |C|, |D| */
+	const __m128 det_sub = _mm_sub_ps(_mm_mul_ps(_CX_SHUF(r0, r2, 0, 2, 0, 2), _CX_SHUF(r1, r3, 1, 3, 1, 3)),
+	                                  _mm_mul_ps(_CX_SHUF(r0, r2, 1, 3, 1, 3), _CX_SHUF(r1, r3, 0, 2, 0, 2)));
+	const __m128 det_a = _CX_SWZ(det_sub, 0, 0, 0, 0);
+	const __m128 det_b = _CX_SWZ(det_sub, 1, 1, 1, 1);
+	const __m128 det_c = _CX_SWZ(det_sub, 2, 2, 2, 2);
+	const __m128 det_d = _CX_SWZ(det_sub, 3, 3, 3, 3);
+
+	const __m128 d_c = _CX_M2_ADJ_MUL(D, C);
+	const __m128 a_b = _CX_M2_ADJ_MUL(A, B);
+
+	__m128 x = _mm_sub_ps(_mm_mul_ps(det_d, A), _CX_M2_MUL(B, d_c));
+	__m128 w = _mm_sub_ps(_mm_mul_ps(det_a, D), _CX_M2_MUL(C, a_b));
+	__m128 y = _mm_sub_ps(_mm_mul_ps(det_b, C), _CX_M2_MUL_ADJ(D, a_b));
+	__m128 z = _mm_sub_ps(_mm_mul_ps(det_c, B), _CX_M2_MUL_ADJ(A, d_c));
+
+	/* |M| = |A||D| + |B||C| - tr((A#B)(D#C)) */
+	__m128 tr = _mm_mul_ps(a_b, _CX_SWZ(d_c, 0, 2, 1, 3));
+	tr = _mm_add_ps(tr, _CX_SWZ(tr, 2, 3, 0, 1));
+	tr = _mm_add_ps(tr, _CX_SWZ(tr, 1, 0, 3, 2));
+	const __m128 det_m = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(det_a, det_d), _mm_mul_ps(det_b, det_c)), tr);
+
+	if (_mm_cvtss_f32(det_m) == 0.0f) {
+		*out = cx_mat4_zero();
+		return;
+	}
+
+	const __m128 rdet = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), det_m);
+	x = _mm_mul_ps(x, rdet);
+	y = _mm_mul_ps(y, rdet);
+	z = _mm_mul_ps(z, rdet);
+	w = _mm_mul_ps(w, rdet);
+
+	/* adjugate shuffle folded into the store */
+	_mm_storeu_ps(&out->m[0],  _CX_SHUF(x, y, 3, 1, 3, 1));
+	_mm_storeu_ps(&out->m[4],  _CX_SHUF(x, y, 2, 0, 2, 0));
+	_mm_storeu_ps(&out->m[8],  _CX_SHUF(z, w, 3, 1, 3, 1));
+	_mm_storeu_ps(&out->m[12], _CX_SHUF(z, w, 2, 0, 2, 0));
+
+#	undef _CX_M2_MUL_ADJ
+#	undef _CX_M2_ADJ_MUL
+#	undef _CX_M2_MUL
+#	undef _CX_SHUF
+#	undef _CX_SWZ
+#else
+	/* cofactors from the same 2x2 minors as cx_mat4_det, NEON uses this path too */
+	const cx_mat4 m = *a;
+
+	const cx_float s0 = m.m00 * m.m11 - m.m10 * m.m01;
+	const cx_float s1 = m.m00 * m.m12 - m.m10 * m.m02;
+	const cx_float s2 = m.m00 * m.m13 - m.m10 * m.m03;
+	const cx_float s3 = m.m01 * m.m12 - m.m11 * m.m02;
+	const cx_float s4 = m.m01 * m.m13 - m.m11 * m.m03;
+	const cx_float s5 = m.m02 * m.m13 - m.m12 * m.m03;
+
+	const cx_float c5 = m.m22 * m.m33 - m.m32 * m.m23;
+	const cx_float c4 = m.m21 * m.m33 - m.m31 * m.m23;
+	const cx_float c3 = m.m21 * m.m32 - m.m31 * m.m22;
+	const cx_float c2 = m.m20 * m.m33 - m.m30 * m.m23;
+	const cx_float c1 = m.m20 * m.m32 - m.m30 * m.m22;
+	const cx_float c0 = m.m20 * m.m31 - m.m30 * m.m21;
+
+	const cx_float det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+	if (det == 0.0) {
+		*out = cx_mat4_zero();
+		return;
+	}
+	const cx_float inv = 1.0 / det;
+
+	*out = cx_mat4_set(( m.m11 * c5 - m.m12 * c4 + m.m13 * c3) * inv,
+	                   (-m.m01 * c5 + m.m02 * c4 - m.m03 * c3) * inv,
+	                   ( m.m31 * s5 - m.m32 * s4 + m.m33 * s3) * inv,
+	                   (-m.m21 * s5 + m.m22 * s4 - m.m23 * s3) * inv,
+
+	                   (-m.m10 * c5 + m.m12 * c2 - m.m13 * c1) * inv,
+	                   ( m.m00 * c5 - m.m02 * c2 + m.m03 * c1) * inv,
+	                   (-m.m30 * s5 + m.m32 * s2 - m.m33 * s1) * inv,
+	                   ( m.m20 * s5 - m.m22 * s2 + m.m23 * s1) * inv,
+
+	                   ( m.m10 * c4 - m.m11 * c2 + m.m13 * c0) * inv,
+	                   (-m.m00 * c4 + m.m01 * c2 - m.m03 * c0) * inv,
+	                   ( m.m30 * s4 - m.m31 * s2 + m.m33 * s0) * inv,
+	                   (-m.m20 * s4 + m.m21 * s2 - m.m23 * s0) * inv,
+
+	                   (-m.m10 * c3 + m.m11 * c1 - m.m12 * c0) * inv,
+	                   ( m.m00 * c3 - m.m01 * c1 + m.m02 * c0) * inv,
+	                   (-m.m30 * s3 + m.m31 * s1 - m.m32 * s0) * inv,
+	                   ( m.m20 * s3 - m.m21 * s1 + m.m22 * s0) * inv);
+#endif
 }
 
 CX_API CX_API_INLINE cx_float cx_mat4_trace(const cx_mat4 a)
@@ -2125,6 +2421,19 @@ CX_API CX_API_INLINE cx_mat4 cx_mat4_from_quat(const cx_quat p)
 					   0.0,                             0.0,                             0.0,                             1.0);
 }
 
+CX_API CX_API_INLINE cx_mat4 cx_mat4_from_trs(const cx_vec3 t, const cx_quat r, const cx_vec3 s)
+{
+	const cx_float p0 = r.w;
+	const cx_float p1 = r.x;
+	const cx_float p2 = r.y;
+	const cx_float p3 = r.z;
+
+	return cx_mat4_set((2 * (CX_SQ(p0) + CX_SQ(p1)) - 1) * s.x, 2 * (p1 * p2 - p0 * p3) * s.y,         2 * (p1 * p3 + p0 * p2) * s.z,         t.x,
+					   2 * (p1 * p2 + p0 * p3) * s.x,         (2 * (CX_SQ(p0) + CX_SQ(p2)) - 1) * s.y, 2 * (p2 * p3 - p0 * p1) * s.z,         t.y,
+					   2 * (p1 * p3 - p0 * p2) * s.x,         2 * (p2 * p3 + p0 * p1) * s.y,         (2 * (CX_SQ(p0) + CX_SQ(p3)) - 1) * s.z, t.z,
+					   0.0,                                   0.0,                                   0.0,                                   1.0);
+}
+
 CX_API CX_API_INLINE void cx_mat4_print(const cx_mat4 a)
 {
 	printf("mat4: ⎡%-6.2f  %6.2f  %6.2f  %6.2f⎤\n"
@@ -2358,6 +2667,7 @@ CX_API CX_API_INLINE void cx_quat_print(const cx_quat p)
 }
 
 
+#ifndef CX_NO_FFT
 /* ------------------------------------------------------------------------------------------------------------ */
 /* dft and fft ------------------------------------------------------------------------------------------------ */
 /* DFT implementation                                                                                           */
@@ -2548,6 +2858,8 @@ CX_API void cx_ifft_bit(cx_complex in[], cx_complex out[], int N)
 	}
 }
 
+#endif /* CX_NO_FFT */
+
 /* ------------------------------------------------------------------------------------------------------------ */
 /* Numerical ODE solver --------------------------------------------------------------------------------------- */
 /* explicit euler  */
@@ -2,6 +2,9 @@
 #include <iostream>
 #include <cmath>
 #include <vector>
+#if __cplusplus >= 202002L
+#include <span>
+#endif
 #include "caylix.h"
 
 namespace cx {
@@ -337,6 +340,12 @@ namespace cx {
 		Mat4 operator-=(const Mat4 &other);
 		Mat4 operator*(const Mat4 &other) const;
 		Vec4 operator*(const Vec4 &other) const;
+		void transform(const Vec4 *in, Vec4 *out, const size_t count) const;
+		void transform(Vec4 *vectors, const size_t count) const;
+		void transform(std::vector<Vec4> &vectors) const;
+#if __cplusplus >= 202002L
+		void transform(std::span<Vec4> vectors) const;
+#endif
 		cx_float det() const;
 		Mat4 transpose() const;
 		Mat4 inverse() const;
@@ -347,6 +356,7 @@ namespace cx {
 		static Mat4 eulerZYX(const cx_float psi, const cx_float theta, const cx_float phi);
 		static Mat4 eulerXYZ(const cx_float phi, const cx_float theta, const cx_float psi);
 		static Mat4 fromQuat(const Quat& q);
+		static Mat4 fromTRS(const Vec3& t, const Quat& r, const Vec3& s);
 		void print();
 
 	private:
@@ -1449,7 +1459,9 @@ namespace cx {
 
 	Mat4 Mat4::operator*(const Mat4 &other) const
 	{
-		return Mat4(cx_mat4_mul(m, other.m));
+		Mat4 result;
+		cx_mat4_mul_ref(&m, &other.m, &result.m);
+		return result;
 	}
 
 	Vec4 Mat4::operator*(const Vec4 &other) const
@@ -1458,6 +1470,30 @@ namespace cx {
 		return Vec4(cx_mat4_vec4_mul(m, v));
 	}
 
+	static_assert(sizeof(Vec4) == sizeof(cx_vec4), "Vec4 must be layout compatible with cx_vec4");
+
+	void Mat4::transform(const Vec4 *in, Vec4 *out, const size_t count) const
+	{
+		cx_mat4_transform_vec4_array(&m, reinterpret_cast<const cx_vec4 *>(in), reinterpret_cast<cx_vec4 *>(out), count);
+	}
+
+	void Mat4::transform(Vec4 *vectors, const size_t count) const
+	{
+		transform(vectors, vectors, count);
+	}
+
+	void Mat4::transform(std::vector<Vec4> &vectors) const
+	{
+		transform(vectors.data(), vectors.size());
+	}
+
+#if __cplusplus >= 202002L
+	void Mat4::transform(std::span<Vec4> vectors) const
+	{
+		transform(vectors.data(), vectors.size());
+	}
+#endif
+
 	cx_float Mat4::det() const
 	{
 		return cx_mat4_det(m);
@@ -1470,7 +1506,9 @@ namespace cx {
 
 	Mat4 Mat4::inverse() const
 	{
-		return Mat4(cx_mat4_inverse(m));
+		Mat4 result;
+		cx_mat4_inverse_ref(&m, &result.m);
+		return result;
 	}
 
 	cx_float Mat4::trace() const
@@ -1509,6 +1547,11 @@ namespace cx {
 		return Mat4(cx_mat4_from_quat(p));
 	}
 
+	Mat4 Mat4::fromTRS(const Vec3& t, const Quat& r, const Vec3& s)
+	{
+		return Mat4(cx_mat4_from_trs(t.get(), r.get(), s.get()));
+	}
+
 	void Mat4::print()
 	{
 		cx_mat4_print(m);
@@ -1702,6 +1745,7 @@ namespace cx {
 		return cx_rk4(f, x, y, h);
 	}
 
+#ifndef CX_NO_FFT
 	inline std::vector<std::complex<cx_float>> fft(const std::vector<std::complex<cx_float>> input)
 	{
 		const int N = input.size();
@@ -1755,5 +1799,6 @@ namespace cx {
 
 		return result;
 	}
+#endif /* CX_NO_FFT */
 #endif
 }
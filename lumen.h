@@ -6,6 +6,7 @@
 #define CX_STATIC
 #define CX_IMPLEMENTATION
 #include "Window.h"
+#include "HeadlessWindow.h"
 #include "Math.h"
 #include "Shader.h"
 #include "Camera.h"
@@ -16,3 +17,31 @@
 #include "Textures.h"
 #include "Inputs.h"
 #include "Renderer.h"
+#include "GLState.h"
+#include "GLExtensions.h"
+#include "StreamBuffer.h"
+#include "UniformBuffer.h"
+#include "ProgramCache.h"
+#include "ShaderPreprocessor.h"
+#include "ShaderLibrary.h"
+#include "ShaderCompiler.h"
+#include "TextureData.h"
+#include "TextureLoader.h"
+#include "MappedFile.h"
+#include "AssetPack.h"
+#include "RectPacker.h"
+#include "TextureAtlas.h"
+#include "TextureTable.h"
+#include "MeshBuffer.h"
+#include "IndirectDrawList.h"
+#include "Profiler.h"
+#include "JobSystem.h"
+#include "Frustum.h"
+#include "CullList.h"
+#include "BVH.h"
+#include "MeshSimplifier.h"
+#include "LODSelector.h"
+#include "MeshOptimizer.h"
+#include "SpriteBatch.h"
+#include "TransformPool.h"
+#include "RenderQueue.h"
@@ -0,0 +1,74 @@
+#!/usr/bin/env python3
+"""Compares two lumen_bench JSON files and flags regressions.
+
+    bench_compare.py <current.json> [--baseline <baseline.json>] [--threshold 0.10] [--filter <substring>]
+
+The baseline defaults to tools/bench_baseline.json, the committed output of
+`make -C tools baseline`. Regenerate it when a change is meant to
+move the numbers, on the machine CI compares against.
+
+A benchmark regresses when its median time per operation grew by more than the threshold
+(10% by default). The exit status is 1 when anything regressed, so CI can fail on it.
+Benchmarks present on only one side are listed but never fail the run, and GL results are
+only compared when both files come from the same renderer.
+"""
+
+import argparse
+import json
+import os
+import sys
+
+DEFAULT_BASELINE = os.path.join(os.path.dirname(os.path.abspath(__file__)), "bench_baseline.json")
+
+
+def load(path):
+    with open(path) as f:
+        data = json.load(f)
+    return data.get("renderer", ""), {r["name"]: r for r in data["results"]}
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Flag lumen_bench regressions against a baseline")
+    parser.add_argument("current")
+    parser.add_argument("--baseline", default=DEFAULT_BASELINE, help="reference results, tools/bench_baseline.json by default")
+    parser.add_argument("--threshold", type=float, default=0.10, help="allowed slowdown, 0.10 = 10%%")
+    parser.add_argument("--filter", default="", help="only compare names containing this")
+    args = parser.parse_args()
+
+    base_renderer, baseline = load(args.baseline)
+    cur_renderer, current = load(args.current)
+    same_renderer = base_renderer == cur_renderer
+    if not same_renderer:
+        print(f"renderer changed ({base_renderer!r} -> {cur_renderer!r}), GL benchmarks are not compared")
+
+    regressions = 0
+    print(f"{'benchmark':<32} {'baseline':>12} {'current':>12} {'change':>9}")
+    for name in sorted(set(baseline) | set(current)):
+        if args.filter not in name:
+            continue
+        if name not in baseline or name not in current:
+            side = "baseline" if name in baseline else "current"
+            print(f"{name:<32} only in {side}")
+            continue
+        if not same_renderer and not name.startswith("math/"):
+            continue
+
+        before = baseline[name]["ns_per_op"]
+        after = current[name]["ns_per_op"]
+        change = (after - before) / before if before > 0 else 0.0
+        mark = ""
+        if change > args.threshold:
+            mark = "  REGRESSION"
+            regressions += 1
+        elif change < -args.threshold:
+            mark = "  faster"
+        print(f"{name:<32} {before:>12.1f} {after:>12.1f} {change * 100:>+8.1f}%{mark}")
+
+    if regressions:
+        print(f"{regressions} regression(s) above {args.threshold * 100:.0f}%")
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,357 @@
+// Microbenchmarks and headless scene benchmarks, written as JSON for tools/bench_compare.py.
+//
+//   lumen_bench [--out <results.json>] [--filter <substring>] [--min-time <seconds>] [--no-gl]
+//
+// Every benchmark is calibrated to run for at least --min-time per sample (0.05 s by default)
+// and sampled 9 times; the median time per operation is what gets compared. GL benchmarks run
+// on a HeadlessWindow, so they work on display-less machines (Mesa llvmpipe), and are skipped
+// with a message when no context can be created. Absolute GL numbers only compare between
+// runs on the same renderer, which is recorded in the JSON.
+//
+// Built by tools/Makefile (`make -C tools`). Nothing here loads images, so neither GLFW nor
+// stb_image (TextureData.cpp) is linked. tools/bench_baseline.json comes from
+// `make -C tools baseline` and is what bench_compare.py compares against by default.
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <string>
+#include <memory>
+#include <vector>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <functional>
+
+#define CX_STATIC
+#define CX_IMPLEMENTATION
+#include "../Math.h"
+#include "../HeadlessWindow.h"
+#include "../Shader.h"
+#include "../Renderer.h"
+#include "../VertexArray.h"
+#include "../VertexBuffer.h"
+#include "../IndexBuffer.h"
+#include "../VertexBufferLayout.h"
+
+using namespace Lumen;
+
+namespace {
+	// Keeps the compiler from dropping a result that is otherwise unused
+	template<typename T>
+	inline void Keep(const T& value)
+	{
+#if defined(__GNUC__) || defined(__clang__)
+		asm volatile("" : : "r"(&value) : "memory");
+#else
+		static volatile const void *sink;
+		sink = &value;
+#endif
+	}
+
+	struct Result {
+		std::string name;
+		double nsPerOp = 0.0;		// median over the samples
+		double minNsPerOp = 0.0;
+		uint64_t iterations = 0;	// per sample
+		uint samples = 0;
+	};
+
+	// `run(n)` performs n operations
+	struct Benchmark {
+		std::string name;
+		std::function<void(uint64_t n)> run;
+	};
+
+	const uint SampleCount = 9;
+
+	double Seconds(std::chrono::steady_clock::time_point start)
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	Result Measure(const Benchmark& benchmark, double minTime)
+	{
+		// one untimed run first for lazy driver work (shader compiles, buffer allocations), then
+		// grow the batch until one sample takes long enough to time reliably
+		benchmark.run(1);
+		uint64_t n = 1;
+		for (;;) {
+			const auto start = std::chrono::steady_clock::now();
+			benchmark.run(n);
+			const double elapsed = Seconds(start);
+			if (elapsed >= minTime || n >= (1ull << 40)) {
+				break;
+			}
+			const double scale = elapsed > 0.0 ? minTime / elapsed * 1.2 : 100.0;
+			n = std::max<uint64_t>(n + 1, (uint64_t)(n * std::min(scale, 100.0)));
+		}
+
+		std::vector<double> times;
+		for (uint s = 0; s < SampleCount; s++) {
+			const auto start = std::chrono::steady_clock::now();
+			benchmark.run(n);
+			times.push_back(Seconds(start) * 1e9 / n);
+		}
+		std::sort(times.begin(), times.end());
+
+		Result result;
+		result.name = benchmark.name;
+		result.nsPerOp = times[times.size() / 2];
+		result.minNsPerOp = times.front();
+		result.iterations = n;
+		result.samples = SampleCount;
+		return result;
+	}
+
+	void AddMathBenchmarks(std::vector<Benchmark>& benchmarks)
+	{
+		const uint count = 256;
+		auto matrices = std::make_shared<std::vector<cx::Mat4>>();
+		auto quats = std::make_shared<std::vector<cx::Quat>>();
+		auto vectors = std::make_shared<std::vector<cx::Vec3>>();
+		for (uint i = 0; i < count; i++) {
+			const float a = i * 0.37f;
+			const cx::Quat q = cx::Quat::fromAxisAngle(cx::Vec3(std::sin(a), std::cos(a), 0.5f).normalize(), a);
+			matrices->push_back(cx::Mat4::fromTRS(cx::Vec3(a, -a, 2.0f * a), q, cx::Vec3(1.0f + 0.01f * i)));
+			quats->push_back(q);
+			vectors->push_back(cx::Vec3(a, 1.0f - a, 0.25f * a));
+		}
+
+		benchmarks.push_back({ "math/mat4_multiply", [=](uint64_t n) {
+			const std::vector<cx::Mat4>& m = *matrices;
+			for (uint64_t i = 0; i < n; i++) {
+				const cx::Mat4 r = m[i % count] * m[(i + 1) % count];
+				Keep(r);
+			}
+		} });
+		benchmarks.push_back({ "math/mat4_inverse", [=](uint64_t n) {
+			const std::vector<cx::Mat4>& m = *matrices;
+			for (uint64_t i = 0; i < n; i++) {
+				const cx::Mat4 r = m[i % count].inverse();
+				Keep(r);
+			}
+		} });
+		benchmarks.push_back({ "math/quat_rotate", [=](uint64_t n) {
+			const std::vector<cx::Quat>& q = *quats;
+			const std::vector<cx::Vec3>& v = *vectors;
+			for (uint64_t i = 0; i < n; i++) {
+				const cx::Vec3 r = q[i % count].rotate(v[(i + 7) % count]);
+				Keep(r);
+			}
+		} });
+		benchmarks.push_back({ "math/quat_slerp", [=](uint64_t n) {
+			const std::vector<cx::Quat>& q = *quats;
+			for (uint64_t i = 0; i < n; i++) {
+				const cx::Quat r = q[i % count].slerp(q[(i + 1) % count], (i % 64) / 64.0f);
+				Keep(r);
+			}
+		} });
+	}
+
+	const char *BenchVertexShader = R"(#version 410 core
+layout(location = 0) in vec2 a_Position;
+
+uniform mat4 u_Model;
+uniform mat4 u_ViewProjection;
+uniform vec4 u_Color;
+uniform float u_Scale;
+
+out vec4 v_Color;
+
+void main()
+{
+	// instanced draws spread their copies over a grid, single draws have gl_InstanceID 0
+	vec2 offset = vec2(gl_InstanceID % 100, gl_InstanceID / 100) * 0.02;
+	v_Color = u_Color;
+	gl_Position = u_ViewProjection * u_Model * vec4(a_Position * u_Scale + offset, 0.0, 1.0);
+}
+)";
+
+	const char *BenchFragmentShader = R"(#version 410 core
+in vec4 v_Color;
+out vec4 o_Color;
+
+void main()
+{
+	o_Color = v_Color;
+}
+)";
+
+	struct Scene {
+		std::shared_ptr<Shader> shader;
+		std::shared_ptr<VertexArray> quad;
+		std::vector<cx::Mat4> models;
+	};
+
+	void AddGLBenchmarks(std::vector<Benchmark>& benchmarks, HeadlessWindow& window)
+	{
+		auto scene = std::make_shared<Scene>();
+
+		ShaderSource source;
+		source.vertex = BenchVertexShader;
+		source.fragment = BenchFragmentShader;
+		scene->shader = std::make_shared<Shader>(source);
+
+		// small quads keep llvmpipe's fill cost out of the submission numbers
+		const float vertices[] = { -0.005f, -0.005f, 0.005f, -0.005f, 0.005f, 0.005f, -0.005f, 0.005f };
+		const uint indices[] = { 0, 1, 2, 2, 3, 0 };
+		VertexBufferLayout layout;
+		layout.Push<float>(2);
+		scene->quad = std::make_shared<VertexArray>();
+		scene->quad->AddBuffer(std::make_shared<VertexBuffer>(vertices, (uint)sizeof(vertices)), layout);
+		scene->quad->AddIndexBuffer(std::make_shared<IndexBuffer>(indices, (uint)sizeof(indices)));
+
+		for (uint i = 0; i < 10000; i++) {
+			scene->models.push_back(cx::Mat4::translation((i % 100) * 0.02f - 1.0f, (i / 100) * 0.02f - 1.0f, 0.0f));
+		}
+
+		scene->shader->Bind();
+		scene->shader->SetUniformMat4("u_ViewProjection", cx::Mat4(1.0f));
+		scene->shader->SetUniform1f("u_Scale", 1.0f);
+		scene->shader->SetUniform4f("u_Color", 1.0f, 0.5f, 0.25f, 1.0f);
+
+		// uniform updates: by name (string hash and map lookup per call) against a stored handle
+		benchmarks.push_back({ "uniform/set_mat4_by_name", [=](uint64_t n) {
+			scene->shader->Bind();
+			for (uint64_t i = 0; i < n; i++) {
+				scene->shader->SetUniformMat4("u_Model", scene->models[i % scene->models.size()]);
+			}
+		} });
+		benchmarks.push_back({ "uniform/set_mat4_by_handle", [=](uint64_t n) {
+			scene->shader->Bind();
+			const Shader::Uniform model = scene->shader->GetUniform("u_Model");
+			for (uint64_t i = 0; i < n; i++) {
+				model.SetMat4(scene->models[i % scene->models.size()]);
+			}
+		} });
+		benchmarks.push_back({ "uniform/set_1f_by_name", [=](uint64_t n) {
+			scene->shader->Bind();
+			for (uint64_t i = 0; i < n; i++) {
+				scene->shader->SetUniform1f("u_Scale", 1.0f + (i & 1) * 1e-3f);
+			}
+		} });
+		benchmarks.push_back({ "uniform/set_1f_by_handle", [=](uint64_t n) {
+			scene->shader->Bind();
+			const Shader::Uniform scale = scene->shader->GetUniform("u_Scale");
+			for (uint64_t i = 0; i < n; i++) {
+				scale.Set1f(1.0f + (i & 1) * 1e-3f);
+			}
+		} });
+
+		// one operation is a whole frame: clear, N objects, finish
+		for (uint objects : { 1000u, 10000u }) {
+			const std::string suffix = std::to_string(objects);
+			benchmarks.push_back({ "draw/per_object_" + suffix, [=, &window](uint64_t n) {
+				const Shader::Uniform model = scene->shader->GetUniform("u_Model");
+				for (uint64_t frame = 0; frame < n; frame++) {
+					Renderer::Clear(GL_COLOR_BUFFER_BIT);
+					scene->shader->Bind();
+					scene->quad->Bind();
+					for (uint i = 0; i < objects; i++) {
+						model.SetMat4(scene->models[i]);
+						Renderer::DrawIndexed(scene->quad);
+					}
+					window.SwapBuffers();
+					glFinish();
+				}
+			} });
+			benchmarks.push_back({ "draw/instanced_" + suffix, [=, &window](uint64_t n) {
+				const Shader::Uniform model = scene->shader->GetUniform("u_Model");
+				for (uint64_t frame = 0; frame < n; frame++) {
+					Renderer::Clear(GL_COLOR_BUFFER_BIT);
+					scene->shader->Bind();
+					scene->quad->Bind();
+					model.SetMat4(scene->models[0]);
+					Renderer::DrawIndexedInstanced(scene->quad, objects);
+					window.SwapBuffers();
+					glFinish();
+				}
+			} });
+		}
+	}
+
+	void WriteJSON(std::ostream& out, const std::vector<Result>& results, const std::string& renderer)
+	{
+		out << "{\n  \"version\": 1,\n  \"renderer\": \"";
+		for (char c : renderer) {
+			if (c != '"' && c != '\\') {
+				out << c;
+			}
+		}
+		out << "\",\n  \"results\": [";
+		char line[512];
+		for (size_t i = 0; i < results.size(); i++) {
+			const Result& r = results[i];
+			std::snprintf(line, sizeof(line), "%s\n    {\"name\": \"%s\", \"ns_per_op\": %.3f, \"min_ns_per_op\": %.3f, \"iterations\": %llu, \"samples\": %u}",
+				i ? "," : "", r.name.c_str(), r.nsPerOp, r.minNsPerOp, (unsigned long long)r.iterations, r.samples);
+			out << line;
+		}
+		out << "\n  ]\n}\n";
+	}
+}
+
+int main(int argc, char **argv)
+{
+	std::string output;
+	std::string filter;
+	double minTime = 0.05;
+	bool gl = true;
+	for (int i = 1; i < argc; i++) {
+		const std::string arg = argv[i];
+		if (arg == "--out" && i + 1 < argc) {
+			output = argv[++i];
+		}
+		else if (arg == "--filter" && i + 1 < argc) {
+			filter = argv[++i];
+		}
+		else if (arg == "--min-time" && i + 1 < argc) {
+			minTime = std::atof(argv[++i]);
+		}
+		else if (arg == "--no-gl") {
+			gl = false;
+		}
+		else {
+			std::cerr << "usage: lumen_bench [--out <results.json>] [--filter <substring>] [--min-time <seconds>] [--no-gl]" << std::endl;
+			return 1;
+		}
+	}
+
+	std::vector<Benchmark> benchmarks;
+	AddMathBenchmarks(benchmarks);
+
+	std::unique_ptr<HeadlessWindow> window;
+	std::string renderer = "none";
+	if (gl) {
+		window.reset(new HeadlessWindow("lumen_bench", 256, 256));
+		if (window->IsValid()) {
+			renderer = window->GetRenderer();
+			AddGLBenchmarks(benchmarks, *window);
+		}
+		else {
+			std::cerr << "no GL context, skipping GL benchmarks" << std::endl;
+		}
+	}
+
+	std::vector<Result> results;
+	for (const Benchmark& benchmark : benchmarks) {
+		if (!filter.empty() && benchmark.name.find(filter) == std::string::npos) {
+			continue;
+		}
+		results.push_back(Measure(benchmark, minTime));
+		const Result& r = results.back();
+		std::printf("%-32s %12.1f ns/op  (min %.1f, %llu iterations)\n", r.name.c_str(), r.nsPerOp, r.minNsPerOp, (unsigned long long)r.iterations);
+		std::fflush(stdout);
+	}
+
+	if (!output.empty()) {
+		std::ofstream out(output, std::ios::trunc);
+		if (!out) {
+			std::cerr << "cannot write " << output << std::endl;
+			return 1;
+		}
+		WriteJSON(out, results, renderer);
+	}
+	return 0;
+}
@@ -0,0 +1,185 @@
+// Offline cooker: packs meshes and textures into one .lpak file that AssetPack maps at runtime.
+//
+//   lumen_cook <out.lpak> <name>=<file> [<name>=<file> ...] [--no-mips]
+//
+// .obj files become meshes with an interleaved position(3) uv(2) normal(3) float layout, run
+// through MeshOptimizer (vertex cache, overdraw and fetch order, 16 bit indices when they fit),
+// and the ACMR before and after is printed. Everything else goes through TextureData::Load, so .dds/.ktx2 keep their
+// compressed levels and other images are decoded and get a box filtered mip chain.
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <unordered_map>
+
+// Textures.h pulls in stb_image, the tool carries its implementation
+#define STB_IMAGE_IMPLEMENTATION
+#include "../AssetPack.h"
+#include "../MeshOptimizer.h"
+
+using namespace Lumen;
+
+namespace {
+	struct ObjMesh {
+		std::vector<float> vertices;
+		std::vector<uint> indices;
+	};
+
+	bool EndsWith(const std::string& s, const std::string& suffix)
+	{
+		return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+	}
+
+	// OBJ index, 1 based or negative (relative to the end); 0 when absent
+	int ResolveIndex(const std::string& token, size_t count)
+	{
+		if (token.empty()) {
+			return 0;
+		}
+		const int index = std::atoi(token.c_str());
+		return index < 0 ? (int)count + index + 1 : index;
+	}
+
+	bool LoadObj(const std::string& path, ObjMesh& mesh)
+	{
+		std::ifstream file(path);
+		if (!file.is_open()) {
+			std::cerr << "Failed to open " << path << std::endl;
+			return false;
+		}
+
+		std::vector<float> positions, uvs, normals;
+		std::unordered_map<std::string, uint> remap;
+		std::string line;
+		while (std::getline(file, line)) {
+			std::istringstream stream(line);
+			std::string tag;
+			stream >> tag;
+
+			float x = 0, y = 0, z = 0;
+			if (tag == "v") {
+				stream >> x >> y >> z;
+				positions.insert(positions.end(), { x, y, z });
+			}
+			else if (tag == "vt") {
+				stream >> x >> y;
+				uvs.insert(uvs.end(), { x, y });
+			}
+			else if (tag == "vn") {
+				stream >> x >> y >> z;
+				normals.insert(normals.end(), { x, y, z });
+			}
+			else if (tag == "f") {
+				std::vector<uint> face;
+				std::string corner;
+				while (stream >> corner) {
+					auto it = remap.find(corner);
+					if (it != remap.end()) {
+						face.push_back(it->second);
+						continue;
+					}
+
+					std::string parts[3];
+					std::istringstream cornerStream(corner);
+					for (int i = 0; i < 3 && std::getline(cornerStream, parts[i], '/'); i++);
+
+					const int p = ResolveIndex(parts[0], positions.size() / 3);
+					const int t = ResolveIndex(parts[1], uvs.size() / 2);
+					const int n = ResolveIndex(parts[2], normals.size() / 3);
+					if (p <= 0 || (size_t)p > positions.size() / 3) {
+						std::cerr << path << ": bad face index '" << corner << "'" << std::endl;
+						return false;
+					}
+
+					float vertex[8] = { };
+					std::copy(&positions[(p - 1) * 3], &positions[(p - 1) * 3] + 3, vertex);
+					if (t > 0 && (size_t)t <= uvs.size() / 2) {
+						std::copy(&uvs[(t - 1) * 2], &uvs[(t - 1) * 2] + 2, vertex + 3);
+					}
+					if (n > 0 && (size_t)n <= normals.size() / 3) {
+						std::copy(&normals[(n - 1) * 3], &normals[(n - 1) * 3] + 3, vertex + 5);
+					}
+
+					const uint index = (uint)(mesh.vertices.size() / 8);
+					mesh.vertices.insert(mesh.vertices.end(), vertex, vertex + 8);
+					remap[corner] = index;
+					face.push_back(index);
+				}
+
+				// polygons are fanned into triangles
+				for (size_t i = 2; i < face.size(); i++) {
+					mesh.indices.insert(mesh.indices.end(), { face[0], face[i - 1], face[i] });
+				}
+			}
+		}
+		return true;
+	}
+}
+
+int main(int argc, char **argv)
+{
+	if (argc < 3) {
+		std::cerr << "usage: lumen_cook <out.lpak> <name>=<file> [<name>=<file> ...] [--no-mips]" << std::endl;
+		return 1;
+	}
+
+	bool generateMips = true;
+	for (int i = 2; i < argc; i++) {
+		if (std::string(argv[i]) == "--no-mips") {
+			generateMips = false;
+		}
+	}
+
+	AssetPackWriter writer;
+	for (int i = 2; i < argc; i++) {
+		const std::string arg = argv[i];
+		if (arg == "--no-mips") {
+			continue;
+		}
+
+		const size_t split = arg.find('=');
+		if (split == std::string::npos) {
+			std::cerr << "expected <name>=<file>, got '" << arg << "'" << std::endl;
+			return 1;
+		}
+		const std::string name = arg.substr(0, split);
+		const std::string path = arg.substr(split + 1);
+
+		if (EndsWith(path, ".obj")) {
+			ObjMesh mesh;
+			if (!LoadObj(path, mesh)) {
+				return 1;
+			}
+
+			VertexBufferLayout layout;
+			layout.Push<float>(3);
+			layout.Push<float>(2);
+			layout.Push<float>(3);
+
+			uint vertexCount = (uint)(mesh.vertices.size() / 8);
+			IndexData indices;
+			const MeshOptimizer::Report report = MeshOptimizer::Optimize(mesh.vertices.data(), vertexCount, layout.GetStride(), mesh.indices, indices);
+			mesh.vertices.resize(vertexCount * 8);
+
+			writer.AddMesh(name, layout, mesh.vertices.data(), (uint)(mesh.vertices.size() * sizeof(float)),
+				indices.GetData(), indices.count, indices.type);
+			std::cout << name << ": " << vertexCount << " vertices, " << mesh.indices.size() / 3 << " triangles, ACMR "
+				<< report.acmrBefore << " -> " << report.acmrAfter << ", ATVR " << report.atvrBefore << " -> " << report.atvrAfter
+				<< ", " << (indices.type == GL_UNSIGNED_SHORT ? 16 : 32) << " bit indices" << std::endl;
+		}
+		else {
+			TextureData texture;
+			if (!texture.Load(path, generateMips)) {
+				return 1;
+			}
+			writer.AddTexture(name, texture);
+			std::cout << name << ": " << texture.GetWidth() << "x" << texture.GetHeight() << ", " << texture.levels.size() << " levels" << std::endl;
+		}
+	}
+
+	return writer.Write(argv[1]) ? 0 : 1;
+}